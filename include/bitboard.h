@@ -0,0 +1,31 @@
+/*
+** COMP20003 Assignment 3 2025
+** bitboard.h
+** File description:
+** Bitboard representation of a game state. Each mask holds one bit per
+** cell, cell y * columns + x, so a MAX_ROWS x MAX_COLUMNS board fits in
+** BB_WORDS 64-bit words.
+*/
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+	#include <stdint.h>
+	#include "gate.h"
+	#define BB_WORDS ((MAX_CELLS + 63) / 64)
+	typedef struct bitboard {
+		uint64_t word[BB_WORDS];
+	} bitboard_t;
+	typedef struct bitstate {
+		board_t const *board; // Board the masks were built from
+		bitboard_t walls; // Cells no piece may enter
+		bitboard_t goals; // Goal cells
+		bitboard_t pieces[MAX_PIECES]; // Cells covered by each piece
+		bitboard_t occupied; // Union of all pieces
+		int piece_x[MAX_PIECES]; // Anchor of each piece, as in gate_t
+		int piece_y[MAX_PIECES];
+	} bitstate_t;
+	void bitstate_init(bitstate_t *bits, board_t const *board);
+	void bitstate_place(bitstate_t *bits, int const *piece_x, int const *piece_y);
+	int bitstate_move(bitstate_t *bits, int piece, char direction);
+	int bitstate_won(bitstate_t const *bits);
+#endif
@@ -8,7 +8,17 @@
 
 #ifndef BSQ_H
 #define BSQ_H
+	#include <stdint.h>
 	#define MAX_PIECES 9
+	#define MAX_COLUMNS (26+2)
+	#define MAX_ROWS (9+2)
+	#define MAX_CELLS (MAX_ROWS * MAX_COLUMNS)
+	// Outcomes of move_location, kept in move_status.
+	#define MOVE_MADE 0
+	#define MOVE_ILLEGAL_DIRECTION 1
+	#define MOVE_ILLEGAL_PIECE 2
+	#define MOVE_PIECE_NOT_FOUND 3
+	#define MOVE_BLOCKED 4
 	typedef struct gate {
 		char *buffer; // Buffer for reading in the puzzle
 		char **map; //A line by line map of chars representing the game state
@@ -24,7 +34,39 @@
 								 // lowest y (tie-breaking with lowest x)
 		int piece_y[MAX_PIECES]; // y locations of part of each piece with 
 								 // lowest y (tie-breaking with lowest x)
+		int move_status; // Outcome of the last move_location call (MOVE_*)
+		struct board *board; // Read-only walls, goals and piece footprints
+		int goals_open; // Goal cells not covered by piece 0, kept up to
+						// date by make_move and render_board
+		uint64_t hash; // Zobrist key of the piece anchors, kept up to date
+					   // by make_move and render_board
 	} gate_t;
+	// Parts of a puzzle which never change during a game, held once and
+	// shared by every state.
+	typedef struct board {
+		int lines; // The number of rows
+		int columns; // The number of columns
+		char cells[MAX_CELLS]; // Walls, goals and spaces with pieces removed,
+							   // indexed by y * columns + x
+		int num_pieces; // The number of pieces on the board
+		int num_goals; // The number of goal cells
+		int empty_spaces; // The number of empty non-goal cells at the start
+		int footprint_size[MAX_PIECES]; // The number of cells in each piece
+		int footprint[MAX_PIECES][MAX_CELLS]; // Cell offsets of each piece
+											  // from its anchor cell
+		int footprint_dy[MAX_PIECES][MAX_CELLS]; // The same offsets split
+		int footprint_dx[MAX_PIECES][MAX_CELLS]; // into rows and columns
+		int goal_cover[MAX_CELLS]; // Goal cells covered by piece 0 when its
+								   // anchor is on each cell
+		uint64_t zobrist[MAX_PIECES][MAX_CELLS]; // Random key for each piece
+												 // anchored on each cell
+	} board_t;
+	// Record returned by make_move, enough to take the move back.
+	typedef struct move_undo {
+		int piece; // The piece moved, -1 if the move was not made
+		int piece_x; // Anchor of the piece before the move
+		int piece_y;
+	} move_undo_t;
 	int helper(void);
 	char *read_map(int reading);
 	char *open_map(char const *path);
@@ -32,19 +74,30 @@
 	int play(char const *path);
 	gate_t count_lines(gate_t gate);
 	int count_columns(gate_t gate, int position);
-	gate_t check_if_player(gate_t gate, int y, int x);
-	gate_t check_if_piece(gate_t gate, int y, int x, int piece);
+	void check_if_player(gate_t *gate, int y, int x);
+	void check_if_piece(gate_t *gate, int y, int x, int piece);
 	gate_t find_player(gate_t gate);
 	gate_t find_pieces(gate_t gate);
 	gate_t key_check(gate_t gate, char pieceNumber, char direction);
 	gate_t attempt_move(gate_t gate, char pieceNumber, char direction);
 	gate_t move_location(gate_t gate, char piece, char direction);
 	int part_can_move(gate_t gate, int y, int x, char direction);
+	move_undo_t make_move(gate_t *gate, int piece, char direction);
+	void unmake_move(gate_t *gate, move_undo_t const *undo);
+	int move_piece(gate_t *gate, int piece, char direction);
+	int is_won(gate_t gate);
 	void win_check(gate_t gate);
+	void report_move(gate_t gate, char piece, char direction);
 	void map_check(gate_t gate);
 	int count_case_number(int y, int x, gate_t gate);
 	int count_goal_square(int y, int x, gate_t gate);
 	int count_player(int y, int x, gate_t gate);
 	gate_t game_management(gate_t gate);
 	int check_tile(int y, int x, gate_t gate);
+	board_t *make_board(gate_t gate);
+	void render_board(board_t const *board, gate_t *gate);
+	int count_open_goals(board_t const *board, int piece_y, int piece_x);
+	uint64_t hash_pieces(board_t const *board, int const *piece_y,
+		int const *piece_x);
+	void free_board(board_t *board);
 #endif
@@ -6,11 +6,22 @@
 #include <stdio.h>
 #include <stdbool.h>
 #include <assert.h>
+#include <pthread.h>
 
 #include "ai.h"
 #include "gate.h"
 #include "radix.h"
 #include "utils.h"
+#include "node.h"
+#include "engine.h"
+#include "arena.h"
+#include "keyset.h"
+#include "stateset.h"
+#include "novelty.h"
+#include "sharded.h"
+#include "heuristic.h"
+#include "bucket.h"
+#include "frontier.h"
 
 #define DEBUG 0
 
@@ -18,6 +29,7 @@
 #define DOWN 'd'
 #define LEFT 'l'
 #define RIGHT 'r'
+/* Same order as MOVEDIRECTIONS, so a direction index encodes a move. */
 char directions[] = {UP, DOWN, LEFT, RIGHT};
 char pieceNames[] = {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9'};
 
@@ -32,9 +44,9 @@ int getPackedSize(gate_t *gate);
 void packMap(gate_t *gate, unsigned char *packedMap);
 
 /**
- * Check if the given state is in a won state.
- */
-bool winning_state(gate_t gate);
+ * Set the piece locations of the state from a map stored by packMap.
+*/
+void unpackMap(gate_t *gate, unsigned char *packedMap);
 
 gate_t* duplicate_state(gate_t* gate) {
 	gate_t* duplicate = (gate_t*)malloc(sizeof(gate_t));
@@ -156,18 +168,200 @@ void free_initial_state(gate_t *init_data) {
 		init_data->soln = NULL;
 	}
 }
+/*
+ * Append node to the queue held in the node arena. Returns the index the
+ * node was stored at.
+ */
+static int enqueueNode(struct arena *queue, struct node *node) {
+	int idx = arenaAlloc(queue);
+	*(struct node *) arenaGet(queue, idx) = *node;
+	return idx;
+}
+
+/* Counters of a search, or of several runs of one, for the stats block. */
+struct searchStats {
+	int dequeued;
+	int enqueued;
+	int duplicated;
+	/* Auxiliary memory, the largest of any run */
+	int memory;
+	/* Width reported as IW(width), 0 for num_pieces + 1 */
+	int width;
+	/* Memory of the visited set kinds, reported when set (algorithm 2) */
+	bool visitedMemory;
+	int radixMemory;
+	int hashSetMemory;
+	/* Generated children by novelty, index 0 counting those not novel, or
+	   NULL when novelty is not measured */
+	int *noveltyHistogram;
+	/* Expanded states looked up in, and found in, a loaded snapshot */
+	int snapshotChecked;
+	int snapshotFound;
+};
+
+/* Prints the stats block shared by the searches. */
+static void printSearchStats(gate_t *init_data, char const *soln, double elapsed,
+	struct searchStats const *stats) {
+	printf("Solution path: %s\n", soln ? soln : "Not Found");
+	printf("Execution time: %lf\n", elapsed);
+	printf("Expanded nodes: %d\n", stats->dequeued);
+	printf("Generated nodes: %d\n", stats->enqueued);
+	printf("Duplicated nodes: %d\n", stats->duplicated);
+	printf("Auxiliary memory usage (bytes): %d\n", stats->memory);
+	if (stats->visitedMemory) {
+		printf("Radix tree memory usage (bytes): %d\n", stats->radixMemory);
+		printf("Hash set memory usage (bytes): %d\n", stats->hashSetMemory);
+	}
+	printf("Number of pieces in the puzzle: %d\n", init_data->num_pieces);
+	printf("Number of steps in solution: %ld\n", soln ? (long)strlen(soln)/2 : 0L);
+	int emptySpaces = 0;
+	for (int i = 0; i < init_data->lines; i++) {
+		for (int j = 0; init_data->map_save[i][j] != '\0'; j++) {
+			if (init_data->map_save[i][j] == ' ') emptySpaces++;
+		}
+	}
+	printf("Number of empty spaces: %d\n", emptySpaces);
+	printf("Solved by IW(%d)\n", stats->width ? stats->width : (init_data->num_pieces + 1));
+	printf("Number of nodes expanded per second: %lf\n", (stats->dequeued + 1) / elapsed);
+	if (stats->noveltyHistogram) {
+		printf("Novelty histogram (generated children):");
+		for (int k = 1; k <= init_data->num_pieces; k++) {
+			if (stats->noveltyHistogram[k]) printf(" %d:%d", k, stats->noveltyHistogram[k]);
+		}
+		printf(" not novel:%d\n", stats->noveltyHistogram[0]);
+	}
+	if (stats->snapshotChecked) {
+		printf("Snapshot states found: %d of %d\n", stats->snapshotFound, stats->snapshotChecked);
+	}
+}
+
+/* Expansions between two checks of a search's control. */
+#define CONTROLINTERVAL 1024
+
+/* Lets searches running side by side be stopped, and caps their memory. */
+struct searchControl {
+	/* The searches sharing it give up once this is set */
+	int *cancel;
+	/* Auxiliary memory the search may use, 0 for no limit */
+	long memoryBudget;
+	/* Set when the search gave up for lack of memory */
+	bool overBudget;
+	/* Set when the search gave up because cancel was set */
+	bool cancelled;
+};
+
+/* 
+ * Whether a search run under control, currently using memoryUsage bytes, 
+ * may go on. Searches without a control always go on.
+ */
+static bool searchMayContinue(struct searchControl *control, long memoryUsage) {
+	if (!control) {
+		return true;
+	}
+	if (__atomic_load_n(control->cancel, __ATOMIC_RELAXED)) {
+		control->cancelled = true;
+		return false;
+	}
+	if (control->memoryBudget && memoryUsage > control->memoryBudget) {
+		control->overBudget = true;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Set of seen packed states of algorithm 2: the radix tree unless the hash
+ * set or the sharded trees were created in its place.
+ */
+struct visitedSet {
+	int atomCount;
+	struct radixTree *rt;
+	struct stateSet *hs;
+	struct shardedRadix *ss;
+};
+
+/*
+ * Duplicate detection for packed states. Inserts the state if absent in one
+ * lookup, returning true if it was new.
+ */
+static bool visitedInsert(struct visitedSet *vs, unsigned char *packed) {
+	if (vs->hs) {
+		return stateSetInsert(vs->hs, packed);
+	}
+	if (vs->ss) {
+		return shardedInsertIfAbsent(vs->ss, packed, vs->atomCount) == NOTPRESENT;
+	}
+	return insertIfAbsent(vs->rt, packed, vs->atomCount) == NOTPRESENT;
+}
+
+/*
+ * Children of one BFS layer waiting for a batched duplicate check: packed
+ * keys back to back, keyBytes each, and the parent and move of each.
+ */
+struct pendingLayer {
+	int keyBytes;
+	int count;
+	int capacity;
+	unsigned char *keys;
+	int *parents;
+	unsigned char *moves;
+	unsigned char *inserted;
+};
+
+static void addPending(struct pendingLayer *layer, unsigned char *packed, int parent, unsigned char move) {
+	if (layer->count == layer->capacity) {
+		layer->capacity = layer->capacity ? layer->capacity * 2 : 1024;
+		layer->keys = (unsigned char *) realloc(layer->keys, (size_t) layer->capacity * layer->keyBytes);
+		layer->parents = (int *) realloc(layer->parents, sizeof(int) * layer->capacity);
+		layer->moves = (unsigned char *) realloc(layer->moves, layer->capacity);
+		layer->inserted = (unsigned char *) realloc(layer->inserted, layer->capacity);
+		assert(layer->keys && layer->parents && layer->moves && layer->inserted);
+	}
+	memcpy(layer->keys + (size_t) layer->count * layer->keyBytes, packed, layer->keyBytes);
+	layer->parents[layer->count] = parent;
+	layer->moves[layer->count++] = move;
+}
+
+/*
+ * Checks every pending child against the visited set in one batch, then
+ * enqueues the new ones in generation order, so the search is the same as
+ * checking them one at a time.
+ */
+static void flushPending(struct pendingLayer *layer, struct visitedSet *vs,
+	struct frontier *queue, int *enqueued, int *duplicatedNodes) {
+	if (vs->hs || vs->ss) {
+		for (int i = 0; i < layer->count; i++) {
+			layer->inserted[i] = visitedInsert(vs, layer->keys + (size_t) i * layer->keyBytes);
+		}
+	} else {
+		insertRadixTreeBatch(vs->rt, layer->keys, layer->count, vs->atomCount, layer->inserted);
+	}
+	for (int i = 0; i < layer->count; i++) {
+		if (!layer->inserted[i]) {
+			(*duplicatedNodes)++;
+			continue;
+		}
+		frontierPush(queue, layer->keys + (size_t) i * layer->keyBytes,
+			layer->parents[i], layer->moves[i]);
+		(*enqueued)++;
+	}
+	layer->count = 0;
+}
+
 /*
  * Algorithm 1: Plain breadth-first search (BFS)
  * - Purpose: Find the shortest sequence of moves to solve the puzzle by
  *   exploring states in breadth-first order.
  * - Inputs: `init_data` (initial puzzle state)
  * - Outputs: assigns `init_data->soln` to a solution string on success.
- * - Notes: This implementation stores full states in a dynamic queue and
- *   does NOT detect duplicate states (no closed set), so may revisit states.
+ * - Notes: This implementation stores lightweight nodes (piece locations,
+ *   parent and last move) in a node arena and does NOT detect duplicate
+ *   states (no closed set), so may revisit states. Each node is rendered
+ *   into a single scratch state when it is expanded.
  * - Complexity: time and memory grow exponentially with solution depth; this
  *   is a baseline reference algorithm.
  */
-void find_solution_algorithm1(gate_t* init_data) {
+void find_solution_algorithm1(gate_t* init_data, struct solverOptions *options) {
 	bool has_won = false;
     int dequeued = 0;
     int enqueued = 0;
@@ -177,78 +371,57 @@ void find_solution_algorithm1(gate_t* init_data) {
 
     double start = now();
 
-	/* Dynamic queue */
-    int qcap = 1024, qhead = 0, qtail = 0;
-    gate_t **queue = (gate_t**)malloc(sizeof(gate_t*) * qcap);
+	/* Scratch state nodes are loaded into, moved by the selected backend */
+	gate_t *state = duplicate_state(init_data);
+	struct searchEngine *engine = newSearchEngine(state, options->backend);
 
-	/* Initial state */
-    gate_t *start_state = duplicate_state(init_data);
-
-	if (!start_state->soln)
-	{
-		start_state->soln = (char*)malloc(1);
-        start_state->soln[0] = '\0';
-	}
-	queue[qtail++] = start_state; enqueued++;
+	/* Queue of nodes, allocated in slabs */
+    int qhead = 0;
+    struct arena *queue = newArena(sizeof(struct node));
 
+	/* Initial state */
+	struct node root;
+	stateToNode(init_data, &root);
+	enqueueNode(queue, &root); enqueued++;
 
-	while (qhead < qtail) {
-		gate_t *u = queue[qhead++]; dequeued++;
+	while (qhead < queue->count) {
+		int ui = qhead++; dequeued++;
+		/* Nodes never move once allocated */
+		struct node *u = (struct node *) arenaGet(queue, ui);
+		engineLoad(engine, u);
 
-		if (winning_state(*u)) {
+		if (engineWon(engine)) {
 			has_won = true;
-			size_t L = strlen(u->soln);
-			soln = (char*)malloc(L + 1);
-			memcpy(soln, u->soln, L + 1);
-			free_state(u, init_data);
+			soln = buildSolution(queue, ui);
 			break;
 		}
 
-
 		for (int p = 0; p < init_data->num_pieces; ++p) {
-			char piece = pieceNames[p];
 			for (int d = 0; d < 4; ++d) {
 				char dir = directions[d];
 
-				// Create a copy of the parent node
-				gate_t *v = duplicate_state(u);
-
-				// Perform the move on the child node
-				gate_t before = *v;
-				*v = move_location(*v, piece, dir);
-
-				// If the move did not change piece p's coordinates, skip
-				if (v->piece_x[p] == u->piece_x[p] && v->piece_y[p] == u->piece_y[p]) {
-					free_state(v, init_data);
+				// Perform the move on the scratch state, skip if piece p can't move
+				if (!engineMove(engine, p, dir)) {
 					continue;
 				}
 
-				// Append the move to the solution string: soln(parent) + piece + dir
-				size_t prevLen = u->soln ? strlen(u->soln) : 0;
-				if (v->soln) free(v->soln);
-				v->soln = (char*)malloc(prevLen + 3);
-				if (prevLen) memcpy(v->soln, u->soln, prevLen);
-				v->soln[prevLen]   = piece;
-				v->soln[prevLen+1] = dir;
-				v->soln[prevLen+2] = '\0';
-
-				if (qtail >= qcap) {
-					qcap *= 2;
-					queue = (gate_t**)realloc(queue, sizeof(gate_t*) * qcap);
-				}
-				queue[qtail++] = v; enqueued++;
+				// Record the child: piece locations, parent and move
+				struct node v;
+				stateToNode(state, &v);
+				v.parent = ui;
+				v.move = ENCODEMOVE(p, d);
+				enqueueNode(queue, &v); enqueued++;
+
+				// Take the move back, restoring the scratch state for the next move
+				engineUndo(engine);
 			}
 		}
-
-		// Finished expanding u
-		free_state(u, init_data);
 	}
 
-	/* Clean up remaining states if loop exited early (found solution) */
-    for (int i = qhead; i < qtail; ++i) {
-        if (queue[i]) free_state(queue[i], init_data);
-    }
-    free(queue);
+	int memoryUsage = queryArenaMemoryUsage(queue);
+    freeArena(queue);
+	freeSearchEngine(engine);
+	free_state(state, init_data);
 
     double elapsed = now() - start;
 
@@ -258,7 +431,7 @@ void find_solution_algorithm1(gate_t* init_data) {
     printf("Expanded nodes: %d\n", dequeued);
     printf("Generated nodes: %d\n", enqueued);
 	printf("Duplicated nodes: %d\n", duplicatedNodes);     /* always 0 for plain BFS */
-	printf("Auxiliary memory usage (bytes): %d\n", 0);     /* no radix tree used */
+	printf("Auxiliary memory usage (bytes): %d\n", memoryUsage);     /* node arena, no radix tree used */
     printf("Number of pieces in the puzzle: %d\n", init_data->num_pieces);
     printf("Number of steps in solution: %ld\n", soln ? (long)strlen(soln)/2 : 0L);
 
@@ -282,191 +455,201 @@ void find_solution_algorithm1(gate_t* init_data) {
 }
 
 
+/* Memory of the visited set of algorithm 2, split by kind of set. */
+static void visitedMemoryUsage(struct visitedSet *vs, int *radixMemory, int *hashSetMemory) {
+	*radixMemory = queryRadixMemoryUsage(vs->rt);
+	if (vs->ss) {
+		*radixMemory += queryShardedMemoryUsage(vs->ss);
+	}
+	*hashSetMemory = vs->hs ? queryStateSetMemoryUsage(vs->hs) : 0;
+}
+
+/* Auxiliary memory of algorithm 2. */
+static int breadthFirstMemory(struct visitedSet *vs, struct frontier *queue,
+	struct pendingLayer *layer, struct keySet *seenKeys, int zobrist) {
+	int radixMemory;
+	int hashSetMemory;
+	visitedMemoryUsage(vs, &radixMemory, &hashSetMemory);
+	int memoryUsage = radixMemory + hashSetMemory;
+	memoryUsage += queryFrontierMemoryUsage(queue);
+	memoryUsage += layer->capacity * (layer->keyBytes + sizeof(int) + 2);
+	if (zobrist != ZOBRIST_OFF) {
+		memoryUsage += queryKeySetMemoryUsage(seenKeys);
+	}
+	return memoryUsage;
+}
+
 /*
- * Algorithm 2: BFS with compact state packing and radix-tree duplicate detection
- * - Purpose: Breadth-first exploration like Algorithm 1 but avoids revisiting
- *   previously seen states by packing each state's piece coordinates into a
- *   compact bit representation and tracking seen atoms in a radix tree.
- * - Inputs: `init_data` (initial puzzle state)
- * - Outputs: assigns `init_data->soln` to the found solution string.
- * - Notes: Packing reduces the cost of duplicate checks; radix tree stores
- *   seen packed states (or atom combinations). This reduces redundant work
- *   compared to plain BFS at the cost of additional memory for the radix tree.
+ * Search of algorithm 2, under control if not NULL. Returns the solution,
+ * or NULL if there is none or the search was stopped, and fills stats.
  */
-void find_solution_algorithm2(gate_t* init_data) {
-	/* Location for packedMap. */
-	int packedBytes = getPackedSize(init_data);
-	unsigned char *packedMap = (unsigned char *) calloc(packedBytes, sizeof(unsigned char));
-	assert(packedMap);
-
-	bool has_won = false;
+static char *breadthFirst(gate_t* init_data, struct solverOptions *options,
+	struct searchControl *control, struct searchStats *stats) {
 	int dequeued = 0;
 	int enqueued = 0;
 	int duplicatedNodes = 0;
 	char *soln = NULL;
-	double start = now();
-	double elapsed;
-	
-	/* Algorithm 1 (plain BFS) is equivalent to a width w = n_pieces + 1 search; */
-	int w = init_data->num_pieces + 1;
 
 	int height = init_data->lines;
 	int width = init_data->num_chars_map / init_data->lines;
 	int atomCount = init_data->num_pieces;
+	int packedBytes = getPackedSize(init_data);
 	struct radixTree *rt = getNewRadixTree(atomCount, height, width);
-	int packedSize = packedBytes;
+	/* Flat hash set or sharded trees of packed states, replace the radix tree when selected */
+	struct visitedSet visited = { atomCount, rt, NULL, NULL };
+	if (options->visited == VISITED_HASHSET) {
+		/* getPackedSize counts bits, see packMap */
+		visited.hs = newStateSet(getPackedSize(init_data));
+	} else if (options->visited == VISITED_SHARDED) {
+		visited.ss = newShardedRadix(atomCount, height, width, VISITEDSHARDS);
+	}
 	unsigned char *curPacked = (unsigned char*)calloc(packedBytes, sizeof(unsigned char));
 	unsigned char *childPacked = (unsigned char*)calloc(packedBytes, sizeof(unsigned char));
-	/* Create initial state copy that owns its resources for queue management */
-	gate_t *start_state = duplicate_state(init_data);
-	/* Ensure starting solution string exists */
-	if (!start_state->soln) {
-		start_state->soln = (char*)malloc(1);
-		start_state->soln[0] = '\0';
+	/* Scratch state nodes are loaded into, moved by the selected backend */
+	gate_t *state = duplicate_state(init_data);
+	struct searchEngine *engine = newSearchEngine(state, options->backend);
+	/* Zobrist keys of seen states, when used as a filter or as the visited set */
+	struct keySet *seenKeys = newKeySet();
+	/* Visited set of an earlier run, every expanded state is looked up in it */
+	struct radixTree *snapshot = NULL;
+	if (options->checkVisited) {
+		snapshot = loadRadixTree(options->checkVisited, atomCount, height, width);
+		if (!snapshot) {
+			fprintf(stderr, "Cannot load snapshot %s\n", options->checkVisited);
+		}
 	}
 	/* Pack and insert start */
-	packMap(start_state, curPacked);
-	insertRadixTree(rt, curPacked, atomCount);
-	/* Simple dynamic queue of gate_t* */
-	int qcap = 1024;
-	int qhead = 0, qtail = 0;
-	gate_t **queue = (gate_t**)malloc(sizeof(gate_t*) * qcap);
-	queue[qtail++] = start_state; enqueued++;
+	packMap(init_data, curPacked);
+	visitedInsert(&visited, curPacked);
+	keySetInsert(seenKeys, init_data->hash);
+	/* Queue of packed states, the root's in curPacked */
+	int keyBytes = (getPackedSize(init_data) + 7) / 8;
+	struct frontier *queue = newFrontier(keyBytes);
+	frontierPush(queue, curPacked, NOPARENT, 0); enqueued++;
+	/* Children of the current layer, when checked in batches */
+	struct pendingLayer layer = { keyBytes, 0, 0, NULL, NULL, NULL, NULL };
+	int layerEnd = queue->count;
 	/* Search loop */
-	while(qhead < qtail) {
-		gate_t *u = queue[qhead++];
+	while(true) {
+		if (options->batch && queue->head == layerEnd) {
+			/* Layer expanded, its children form the next one */
+			flushPending(&layer, &visited, queue, &enqueued, &duplicatedNodes);
+			layerEnd = queue->count;
+		}
+		if (queue->head >= queue->count) {
+			break;
+		}
+		if (control && dequeued % CONTROLINTERVAL == 0 && !searchMayContinue(control,
+			breadthFirstMemory(&visited, queue, &layer, seenKeys, options->zobrist))) {
+			break;
+		}
+		int ui = frontierPop(queue, curPacked);
 		dequeued++;
-		/* Check goal */
-		if (winning_state(*u)) {
-			has_won = true;
-			/* Copy solution string out */
-			if (u->soln) {
-				if (soln) free(soln);
-				soln = (char*)malloc(strlen(u->soln) + 1);
-				strcpy(soln, u->soln);
+		if (snapshot) {
+			stats->snapshotChecked++;
+			if (checkPresent(snapshot, curPacked, atomCount) == PRESENT) {
+				stats->snapshotFound++;
 			}
-			/* free popped state and remaining queue items */
-			free_state(u, init_data);
+		}
+		/* Rebuild the node's state from its packed form */
+		struct node u;
+		unpackMap(state, curPacked);
+		stateToNode(state, &u);
+		engineLoad(engine, &u);
+		/* Check goal */
+		if (engineWon(engine)) {
+			soln = frontierSolution(queue, ui);
+			/* Children generated so far are counted as if checked one by one */
+			flushPending(&layer, &visited, queue, &enqueued, &duplicatedNodes);
 			break;
 		}
 		/* Generate successors: iterate pieces then directions */
 		for (int p = 0; p < init_data->num_pieces; p++) {
-			char piece = pieceNames[p];
 			for (int d = 0; d < 4; d++) {
 				char dir = directions[d];
-				/* Create child by duplicating u */
-				gate_t *v = duplicate_state(u);
-				/* Append move to solution string: piece + dir */
-				int prevLen = v->soln ? strlen(v->soln) : 0;
-				char *newSol = (char*)malloc(prevLen + 3); /* two chars + terminator */
-				if (prevLen > 0) memcpy(newSol, v->soln, prevLen);
-				newSol[prevLen] = piece;
-				newSol[prevLen+1] = dir;
-				newSol[prevLen+2] = '\0';
-				if (v->soln) free(v->soln);
-				v->soln = newSol;
-				/* Correct approach: perform move on a local copy and then overwrite v's contents. */
-				gate_t tmp = *v; /* copy of current duplicated state */
-				/* Actually perform move on tmp */
-				tmp = move_location(tmp, piece, dir);
-				/* Now compare packed representation to see if any change occurred */
-				/* Pack u and tmp */
-				packMap(u, curPacked);
-				packMap(&tmp, childPacked);
-				/* If identical, skip */
-				bool identical = (memcmp(curPacked, childPacked, packedBytes) == 0);
-				if (identical) {
-					/* no state change - drop v */
-					free_state(v, init_data);
+				/* Perform the move on the scratch state, skip if piece p can't move */
+				if (!engineMove(engine, p, dir)) {
 					continue;
 				}
-				/* Check radix duplicate */
-				if (checkPresent(rt, childPacked, atomCount) == PRESENT) {
-					duplicatedNodes++;
-					free_state(v, init_data);
+				packMap(state, childPacked);
+				uint64_t childHash = engineHash(engine);
+				/* Take the move back, restoring the scratch state for the next move */
+				engineUndo(engine);
+				if (options->batch) {
+					addPending(&layer, childPacked, ui, ENCODEMOVE(p, d));
 					continue;
 				}
-				/* Not seen, insert and enqueue */
-				insertRadixTree(rt, childPacked, atomCount);
-				/* Overwrite v's dynamic data with tmp's results */
-				/* Create new copies of tmp's maps first (tmp may share pointers with v)
-				then free old storage and attach the new copies to v. */
-				char **new_map = (char**)malloc(sizeof(char*) * tmp.lines);
-				char **new_map_save = (char**)malloc(sizeof(char*) * tmp.lines);
-				for (int i = 0; i < tmp.lines; i++) {
-					new_map[i] = (char*)malloc(strlen(tmp.map[i]) + 1);
-					strcpy(new_map[i], tmp.map[i]);
-					new_map_save[i] = (char*)malloc(strlen(tmp.map_save[i]) + 1);
-					strcpy(new_map_save[i], tmp.map_save[i]);
+				/* Check duplicate, inserting the state if it was not seen */
+				bool seen;
+				if (options->zobrist == ZOBRIST_OFF) {
+					seen = !visitedInsert(&visited, childPacked);
+				} else if (keySetInsert(seenKeys, childHash)) {
+					/* Unseen key, so certainly an unseen state */
+					seen = false;
+					if (options->zobrist != ZOBRIST_TRUST) {
+						visitedInsert(&visited, childPacked);
+					}
+				} else {
+					/* Seen key: a duplicate, unless the full key shows a collision */
+					seen = (options->zobrist == ZOBRIST_TRUST)
+						|| !visitedInsert(&visited, childPacked);
 				}
-				/* Now free previous v storage */
-				for (int i = 0; i < v->lines; i++) { if (v->map[i]) free(v->map[i]); }
-				for (int i = 0; i < v->lines; i++) { if (v->map_save[i]) free(v->map_save[i]); }
-				free(v->map); free(v->map_save);
-				/* Attach new copies */
-				v->map = new_map;
-				v->map_save = new_map_save;
-				/* Copy scalar fields */
-				v->lines = tmp.lines;
-				v->player_x = tmp.player_x; v->player_y = tmp.player_y;
-				v->num_chars_map = tmp.num_chars_map; v->num_pieces = tmp.num_pieces;
-				for (int i = 0; i < v->num_pieces; i++) { v->piece_x[i] = tmp.piece_x[i]; v->piece_y[i] = tmp.piece_y[i]; }
-				/* Enqueue v */
-				/* Grow queue if necessary */
-				if (qtail >= qcap) {
-					qcap *= 2;
-					queue = (gate_t**)realloc(queue, sizeof(gate_t*) * qcap);
+				if (seen) {
+					duplicatedNodes++;
+					continue;
 				}
-				queue[qtail++] = v; enqueued++;
+				/* Not seen, enqueue */
+				frontierPush(queue, childPacked, ui, ENCODEMOVE(p, d)); enqueued++;
 			}
 		}
-		/* Free u after expansion */
-		free_state(u, init_data);
-	}
-	/* Clean up queue remainder if not emptied by solution */
-	for (int i = qhead; i < qtail; i++) {
-		if (queue[i]) free_state(queue[i], init_data);
 	}
 
-	/* Output statistics */
-	elapsed = now() - start;
-	printf("Solution path: ");
-	printf("%s\n", soln);
-	printf("Execution time: %lf\n", elapsed);
-	printf("Expanded nodes: %d\n", dequeued);
-	printf("Generated nodes: %d\n", enqueued);
-	printf("Duplicated nodes: %d\n", duplicatedNodes);
-	int memoryUsage = 0;
-	// Algorithm 2: Memory usage, uncomment to add.
-	memoryUsage += queryRadixMemoryUsage(rt);
-
-	printf("Auxiliary memory usage (bytes): %d\n", memoryUsage);
-	printf("Number of pieces in the puzzle: %d\n", init_data->num_pieces);
-	printf("Number of steps in solution: %ld\n", strlen(soln)/2);
-	int emptySpaces = 0;
-	/*
-	 * FILL IN: Add empty space check for your solution.
-	 */
-	/* Count spaces in the initial map_save (or map if available) */
-	for (int i = 0; i < init_data->lines; i++) {
-		for (int j = 0; init_data->map_save[i][j] != '\0'; j++) {
-			if (init_data->map_save[i][j] == ' ') emptySpaces++;
-		}
+	stats->dequeued = dequeued;
+	stats->enqueued = enqueued;
+	stats->duplicated = duplicatedNodes;
+	stats->memory = breadthFirstMemory(&visited, queue, &layer, seenKeys, options->zobrist);
+	stats->visitedMemory = true;
+	visitedMemoryUsage(&visited, &stats->radixMemory, &stats->hashSetMemory);
+	if (options->saveVisited && saveRadixTree(rt, options->saveVisited) != 0) {
+		fprintf(stderr, "Cannot save snapshot %s\n", options->saveVisited);
 	}
-	printf("Number of empty spaces: %d\n", emptySpaces);
-	printf("Solved by IW(%d)\n", w);
-	printf("Number of nodes expanded per second: %lf\n", (dequeued + 1) / elapsed);
 
-	
-	free(queue);
+	if (snapshot) freeRadixTree(snapshot);
+	freeFrontier(queue);
+	free(layer.keys);
+	free(layer.parents);
+	free(layer.moves);
+	free(layer.inserted);
+	freeKeySet(seenKeys);
+	freeSearchEngine(engine);
+	free_state(state, init_data);
 	if (rt) freeRadixTree(rt);
+	freeStateSet(visited.hs);
+	freeShardedRadix(visited.ss);
 	if (curPacked) free(curPacked);
 	if (childPacked) free(childPacked);
-	
-	/* Free associated memory. */
-	if(packedMap) {
-		free(packedMap);
-	}
+	return soln;
+}
+
+/*
+ * Algorithm 2: BFS with compact state packing and radix-tree duplicate detection
+ * - Purpose: Breadth-first exploration like Algorithm 1 but avoids revisiting
+ *   previously seen states by packing each state's piece coordinates into a
+ *   compact bit representation and tracking seen atoms in a radix tree.
+ * - Inputs: `init_data` (initial puzzle state)
+ * - Outputs: assigns `init_data->soln` to the found solution string.
+ * - Notes: Packing reduces the cost of duplicate checks; radix tree stores
+ *   seen packed states (or atom combinations). This reduces redundant work
+ *   compared to plain BFS at the cost of additional memory for the radix tree.
+ *   With options->batch, children are checked a whole BFS layer at a time,
+ *   sorted by key, rather than as they are generated.
+ */
+void find_solution_algorithm2(gate_t* init_data, struct solverOptions *options) {
+	struct searchStats stats = {0};
+	double start = now();
+	char *soln = breadthFirst(init_data, options, NULL, &stats);
+	double elapsed = now() - start;
+	printSearchStats(init_data, soln, elapsed, &stats);
 
 	/* Assign solution back to the gate structure */
 	if (soln) {
@@ -477,189 +660,580 @@ void find_solution_algorithm2(gate_t* init_data) {
 	free_initial_state(init_data);
 }
 
-static inline void append_move(gate_t *child, const char *parent_soln, char piece, char dir) {
-    size_t L = parent_soln ? strlen(parent_soln) : 0;
-    child->soln = (char*)malloc(L + 3);
-    if (L) memcpy(child->soln, parent_soln, L);
-    child->soln[L]   = piece;
-    child->soln[L+1] = dir;
-    child->soln[L+2] = '\0';
+/*
+ * Children one thread generated from its share of a BFS layer that fall in
+ * the visited set shards of one owning thread, in generation order: packed
+ * keys back to back, keyBytes each, their parents and moves, and whether
+ * each turned out to be new.
+ */
+struct layerChildren {
+	int count;
+	int capacity;
+	unsigned char *keys;
+	int *parents;
+	unsigned char *moves;
+	unsigned char *inserted;
+};
+
+struct parallelBfs;
+
+/* One thread of the parallel BFS, with its own scratch state. */
+struct bfsWorker {
+	int id;
+	pthread_t thread;
+	struct parallelBfs *bfs;
+	gate_t *state;
+	struct searchEngine *engine;
+	unsigned char *packed;
+	/* Children of the worker's share, one bucket per owning thread */
+	struct layerChildren *buckets;
+	/* Owner of each child in generation order, to merge the buckets back */
+	int orderCount;
+	int orderCapacity;
+	unsigned char *order;
+	/* Next child of each bucket while merging */
+	int *cursors;
+	/* New children this worker found in each thread's bucket for it */
+	int *fresh;
+	/* Queue index the worker's new children are written from */
+	int offset;
+	/* First node of the worker's share of the layer */
+	int first;
+	/* Nodes of the share expanded, and children of them seen in earlier
+	   layers, counted once the goal is known */
+	int layerExpanded;
+	int layerDuplicated;
+	/* Children found already inserted in the worker's shards */
+	int duplicated;
+};
+
+/* State shared by the threads of the parallel BFS. */
+struct parallelBfs {
+	int threads;
+	int atomCount;
+	int keyBytes;
+	struct frontier *queue;
+	struct shardedRadix *visited;
+	struct bfsWorker *workers;
+	pthread_barrier_t barrier;
+	/* Nodes of the layer being expanded */
+	int layerStart;
+	int layerEnd;
+	/* Lowest index of a goal node in the layer, INT_MAX if none */
+	int goal;
+	bool done;
+	int enqueued;
+	/* Expansions and children seen in earlier layers, up to the goal */
+	int expanded;
+	int duplicated;
+};
+
+static void addLayerChild(struct bfsWorker *worker, int owner, unsigned char *packed,
+	int parent, unsigned char move) {
+	int keyBytes = worker->bfs->keyBytes;
+	struct layerChildren *children = &worker->buckets[owner];
+	if (children->count == children->capacity) {
+		children->capacity = children->capacity ? children->capacity * 2 : 1024;
+		children->keys = (unsigned char *) realloc(children->keys, (size_t) children->capacity * keyBytes);
+		children->parents = (int *) realloc(children->parents, sizeof(int) * children->capacity);
+		children->moves = (unsigned char *) realloc(children->moves, children->capacity);
+		children->inserted = (unsigned char *) realloc(children->inserted, children->capacity);
+		assert(children->keys && children->parents && children->moves && children->inserted);
+	}
+	memcpy(children->keys + (size_t) children->count * keyBytes, packed, keyBytes);
+	children->parents[children->count] = parent;
+	children->moves[children->count++] = move;
+	if (worker->orderCount == worker->orderCapacity) {
+		worker->orderCapacity = worker->orderCapacity ? worker->orderCapacity * 2 : 1024;
+		worker->order = (unsigned char *) realloc(worker->order, worker->orderCapacity);
+		assert(worker->order);
+	}
+	worker->order[worker->orderCount++] = (unsigned char) owner;
 }
 
-void find_solution_algorithm3(gate_t* init_data) {
-	 /*
-	  * Algorithm 3: Iterative Width (IW) / novelty-based search
-	  * - Purpose: Perform a novelty-driven breadth-first search with increasing
-	  *   width (w). For each width, nodes are kept if they introduce a novel
-	  *   combination of atom-values (nCr of size k) for some k <= w.
-	  * - Inputs: `init_data` (initial puzzle state)
-	  * - Outputs: assigns `init_data->soln` to the found solution string.
-	  * - Notes: This method stores a radix tree for each k to record seen
-	  *   combinations and prunes nodes that are not novel up to width w. It is
-	  *   much more selective than plain BFS and can dramatically reduce search
-	  *   effort for many domains.
-	  */
+/*
+ * Expands the worker's contiguous share of the layer. States seen in earlier
+ * layers are dropped here; the set is not written to until every thread is 
+ * done, so it is read without locks and what is dropped does not depend on
+ * timing. Children are put in the bucket of the thread owning their shard.
+ * Once a goal is posted, nodes after it are skipped, but a thread may 
+ * already have expanded some before the lowest goal was known; that work is
+ * discarded when the layer is counted.
+ */
+static void expandShare(struct bfsWorker *worker) {
+	struct parallelBfs *bfs = worker->bfs;
+	int layerSize = bfs->layerEnd - bfs->layerStart;
+	int first = bfs->layerStart + (int) ((long) layerSize * worker->id / bfs->threads);
+	int last = bfs->layerStart + (int) ((long) layerSize * (worker->id + 1) / bfs->threads);
+	for (int t = 0; t < bfs->threads; t++) {
+		worker->buckets[t].count = 0;
+	}
+	worker->orderCount = 0;
+	worker->first = first;
+	worker->layerExpanded = 0;
+	worker->layerDuplicated = 0;
+	for (int ui = first; ui < last; ui++) {
+		/* A goal earlier in the layer makes the rest of this share irrelevant */
+		if (__atomic_load_n(&bfs->goal, __ATOMIC_RELAXED) < ui) {
+			return;
+		}
+		worker->layerExpanded++;
+		/* Rebuild the node's state from its packed form */
+		struct node u;
+		unpackMap(worker->state, frontierKey(bfs->queue, ui));
+		stateToNode(worker->state, &u);
+		engineLoad(worker->engine, &u);
+		if (engineWon(worker->engine)) {
+			int goal = __atomic_load_n(&bfs->goal, __ATOMIC_RELAXED);
+			while (ui < goal && !__atomic_compare_exchange_n(&bfs->goal, &goal, ui,
+				false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			}
+			return;
+		}
+		for (int p = 0; p < bfs->atomCount; p++) {
+			for (int d = 0; d < 4; d++) {
+				if (!engineMove(worker->engine, p, directions[d])) {
+					continue;
+				}
+				packMap(worker->state, worker->packed);
+				engineUndo(worker->engine);
+				if (shardedCheckPresentUnlocked(bfs->visited, worker->packed, bfs->atomCount) == PRESENT) {
+					worker->layerDuplicated++;
+					continue;
+				}
+				int shard = shardedShardOf(bfs->visited, worker->packed, bfs->atomCount);
+				addLayerChild(worker, shard % bfs->threads, worker->packed, ui, ENCODEMOVE(p, d));
+			}
+		}
+	}
+}
+
+/*
+ * Inserts the children every thread put in its bucket for this worker, 
+ * thread by thread. Shares are in layer order, so this is generation order
+ * and the first copy of a state generated is the one kept, as in algorithm
+ * 2. No two threads share a shard. In the goal's layer, threads whose share
+ * starts after the goal are skipped: the other threads expanded exactly the
+ * nodes before it, so the counts are algorithm 2's.
+ */
+static void insertOwnedChildren(struct bfsWorker *worker) {
+	struct parallelBfs *bfs = worker->bfs;
+	for (int t = 0; t < bfs->threads; t++) {
+		struct layerChildren *children = &bfs->workers[t].buckets[worker->id];
+		worker->fresh[t] = 0;
+		if (bfs->workers[t].first > bfs->goal) {
+			continue;
+		}
+		for (int i = 0; i < children->count; i++) {
+			children->inserted[i] = shardedInsertIfAbsent(bfs->visited,
+				children->keys + (size_t) i * bfs->keyBytes, bfs->atomCount) == NOTPRESENT;
+			if (children->inserted[i]) {
+				worker->fresh[t]++;
+			} else {
+				worker->duplicated++;
+			}
+		}
+	}
+}
 
+/*
+ * Counts the layer, up to the goal if there is one, then sizes the next 
+ * layer: each worker's new children go after those of the workers before 
+ * it, a prefix sum of their counts, and the queue grows by the total in one
+ * step, dropping the packed states of the layer just expanded.
+ */
+static void planNextLayer(struct parallelBfs *bfs) {
+	int total = 0;
+	for (int t = 0; t < bfs->threads; t++) {
+		struct bfsWorker *worker = &bfs->workers[t];
+		if (worker->first <= bfs->goal) {
+			bfs->expanded += worker->layerExpanded;
+			bfs->duplicated += worker->layerDuplicated;
+		}
+		worker->offset = bfs->layerEnd + total;
+		for (int w = 0; w < bfs->threads; w++) {
+			total += bfs->workers[w].fresh[t];
+		}
+	}
+	bfs->enqueued += total;
+	if (bfs->goal != INT_MAX) {
+		bfs->done = true;
+		return;
+	}
+	bfs->queue->head = bfs->layerEnd;
+	frontierReserve(bfs->queue, total);
+	bfs->layerStart = bfs->layerEnd;
+	bfs->layerEnd = bfs->queue->count;
+	bfs->done = (total == 0);
+}
+
+/* Writes the worker's new children to its part of the next layer, in generation order. */
+static void writeNextLayer(struct bfsWorker *worker) {
+	struct parallelBfs *bfs = worker->bfs;
+	int next = worker->offset;
+	for (int t = 0; t < bfs->threads; t++) {
+		worker->cursors[t] = 0;
+	}
+	for (int i = 0; i < worker->orderCount; i++) {
+		struct layerChildren *children = &worker->buckets[worker->order[i]];
+		int c = worker->cursors[worker->order[i]]++;
+		if (children->inserted[c]) {
+			frontierSet(bfs->queue, next++, children->keys + (size_t) c * bfs->keyBytes,
+				children->parents[c], children->moves[c]);
+		}
+	}
+}
+
+/* 
+ * Every thread runs the same phases per layer, separated by barriers: 
+ * expand a share of the layer, insert the children of its own shards, let
+ * thread 0 size the next layer, then write its own part of it.
+ */
+static void *parallelBfsWorker(void *arg) {
+	struct bfsWorker *worker = (struct bfsWorker *) arg;
+	struct parallelBfs *bfs = worker->bfs;
+	while (true) {
+		expandShare(worker);
+		pthread_barrier_wait(&bfs->barrier);
+		insertOwnedChildren(worker);
+		pthread_barrier_wait(&bfs->barrier);
+		if (worker->id == 0) {
+			planNextLayer(bfs);
+		}
+		pthread_barrier_wait(&bfs->barrier);
+		if (bfs->done) {
+			break;
+		}
+		writeNextLayer(worker);
+		pthread_barrier_wait(&bfs->barrier);
+	}
+	return NULL;
+}
+
+/*
+ * Parallel BFS
+ * - Purpose: Algorithm 2 spread over options->threads threads, one BFS layer
+ *   at a time.
+ * - Inputs: `init_data` (initial puzzle state)
+ * - Outputs: assigns `init_data->soln` to the found solution string.
+ * - Notes: Each thread expands a contiguous share of the layer into its own
+ *   buckets, one per thread owning the children's visited set shards, 
+ *   dropping states seen in earlier layers. Then each thread inserts the 
+ *   children in its buckets, in generation order, and writes its own new 
+ *   children to the queue from an offset summed from the threads before it,
+ *   again in generation order. The queue is therefore the same as 
+ *   algorithm 2's, and the goal of lowest index in the first layer holding
+ *   one is the state algorithm 2 would have found: the same solution, 
+ *   whatever the thread count or timing. Work past the goal is discarded, 
+ *   so the counts are algorithm 2's too. Experimental: its scaling with the
+ *   thread count has not been measured.
+ */
+void find_solution_parallel(gate_t* init_data, struct solverOptions *options) {
+	char *soln = NULL;
+	double start = now();
+
+	int height = init_data->lines;
+	int width = init_data->num_chars_map / init_data->lines;
+	struct parallelBfs bfs;
+	bfs.threads = options->threads > 0 ? options->threads : (int) sysconf(_SC_NPROCESSORS_ONLN);
+	if (bfs.threads < 1) {
+		bfs.threads = 1;
+	}
+	if (bfs.threads > MAXTHREADS) {
+		/* A thread with no shard would have nothing to insert */
+		bfs.threads = MAXTHREADS;
+	}
+	bfs.atomCount = init_data->num_pieces;
+	bfs.keyBytes = (getPackedSize(init_data) + 7) / 8;
+	bfs.queue = newFrontier(bfs.keyBytes);
+	bfs.visited = newShardedRadix(bfs.atomCount, height, width, VISITEDSHARDS);
+	bfs.goal = INT_MAX;
+	bfs.done = false;
+	bfs.enqueued = 0;
+	bfs.expanded = 0;
+	bfs.duplicated = 0;
+	pthread_barrier_init(&bfs.barrier, NULL, bfs.threads);
+
+	/* getPackedSize counts bits, see packMap */
+	unsigned char *packed = (unsigned char *) calloc(getPackedSize(init_data), 1);
+	assert(packed);
+	packMap(init_data, packed);
+	shardedInsertIfAbsent(bfs.visited, packed, bfs.atomCount);
+	frontierPush(bfs.queue, packed, NOPARENT, 0);
+	free(packed);
+	bfs.enqueued++;
+	bfs.layerStart = 0;
+	bfs.layerEnd = bfs.queue->count;
+
+	bfs.workers = (struct bfsWorker *) calloc(bfs.threads, sizeof(struct bfsWorker));
+	assert(bfs.workers);
+	for (int t = 0; t < bfs.threads; t++) {
+		struct bfsWorker *worker = &bfs.workers[t];
+		worker->id = t;
+		worker->bfs = &bfs;
+		worker->state = duplicate_state(init_data);
+		worker->engine = newSearchEngine(worker->state, options->backend);
+		worker->packed = (unsigned char *) calloc(getPackedSize(init_data), 1);
+		worker->buckets = (struct layerChildren *) calloc(bfs.threads, sizeof(struct layerChildren));
+		worker->cursors = (int *) calloc(bfs.threads, sizeof(int));
+		worker->fresh = (int *) calloc(bfs.threads, sizeof(int));
+		assert(worker->packed && worker->buckets && worker->cursors && worker->fresh);
+	}
+	for (int t = 1; t < bfs.threads; t++) {
+		pthread_create(&bfs.workers[t].thread, NULL, parallelBfsWorker, &bfs.workers[t]);
+	}
+	parallelBfsWorker(&bfs.workers[0]);
+	for (int t = 1; t < bfs.threads; t++) {
+		pthread_join(bfs.workers[t].thread, NULL);
+	}
+	if (bfs.goal != INT_MAX) {
+		soln = frontierSolution(bfs.queue, bfs.goal);
+	}
+
+	double elapsed = now() - start;
+	struct searchStats stats = {0};
+	stats.dequeued = bfs.expanded;
+	stats.enqueued = bfs.enqueued;
+	stats.duplicated = bfs.duplicated;
+	stats.memory = queryFrontierMemoryUsage(bfs.queue) + queryShardedMemoryUsage(bfs.visited);
+	for (int t = 0; t < bfs.threads; t++) {
+		struct bfsWorker *worker = &bfs.workers[t];
+		stats.duplicated += worker->duplicated;
+		stats.memory += worker->orderCapacity + 2 * bfs.threads * sizeof(int);
+		for (int w = 0; w < bfs.threads; w++) {
+			stats.memory += worker->buckets[w].capacity * (bfs.keyBytes + sizeof(int) + 2);
+		}
+	}
+	printSearchStats(init_data, soln, elapsed, &stats);
+	printf("Threads: %d\n", bfs.threads);
+
+	for (int t = 0; t < bfs.threads; t++) {
+		struct bfsWorker *worker = &bfs.workers[t];
+		freeSearchEngine(worker->engine);
+		free_state(worker->state, init_data);
+		free(worker->packed);
+		for (int w = 0; w < bfs.threads; w++) {
+			free(worker->buckets[w].keys);
+			free(worker->buckets[w].parents);
+			free(worker->buckets[w].moves);
+			free(worker->buckets[w].inserted);
+		}
+		free(worker->buckets);
+		free(worker->order);
+		free(worker->cursors);
+		free(worker->fresh);
+	}
+	free(bfs.workers);
+	pthread_barrier_destroy(&bfs.barrier);
+	freeShardedRadix(bfs.visited);
+	freeFrontier(bfs.queue);
+
+	if (soln) {
+		init_data->soln = soln;
+	}
+	free_initial_state(init_data);
+}
+
+/* Goal of one IW run: piece 0 covering each of the keptCount goal cells in
+   kept, and at least target goal cells in all. */
+struct iwGoal {
+	int const *kept;
+	int keptCount;
+	int target;
+};
+
+/* Whether piece 0, anchored where it is in state, reaches goal. */
+static bool iwGoalReached(gate_t *state, struct iwGoal const *goal) {
+	board_t const *board = state->board;
+	int anchor = state->piece_y[0] * board->columns + state->piece_x[0];
+	if (board->goal_cover[anchor] < goal->target) {
+		return false;
+	}
+	for (int i = 0; i < goal->keptCount; i++) {
+		bool covered = false;
+		for (int k = 0; k < board->footprint_size[0] && !covered; k++) {
+			covered = (anchor + board->footprint[0][k] == goal->kept[i]);
+		}
+		if (!covered) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/* 
+	Iterated width from start, at widths up to maxWidth, until goal is 
+	reached, adding its counters to stats and under control if not NULL.
+	Returns the moves taken, or NULL if goal cannot be reached within 
+	maxWidth or the search was stopped.
+*/
+static char *iteratedWidth(gate_t *start, struct solverOptions *options,
+	struct iwGoal const *goal, int maxWidth, struct searchControl *control,
+	struct searchStats *stats) {
 	 /* packedBytes: getPackedSize currently returns a bit-count; code keeps
 		 the existing approach and allocates bytes accordingly (may over-allocate) */
-    int packedBytes = getPackedSize(init_data);
+    int packedBytes = getPackedSize(start);
     unsigned char *packedMap = (unsigned char*)calloc(packedBytes, 1);
     assert(packedMap);
 
-    int wmax = init_data->num_pieces + 1;
-    int height = init_data->lines;
-    int width  = init_data->num_chars_map / init_data->lines;
+    int wmax = start->num_pieces + 1;
+    int kmax = start->num_pieces;
+    if (maxWidth < wmax) wmax = maxWidth;
+    int height = start->lines;
+    int width  = start->num_chars_map / start->lines;
 
-	/* For each k we maintain a radixTree that stores seen atom-combinations of size k */
-	struct radixTree **rts = (struct radixTree**)calloc(wmax + 1, sizeof(*rts));
+	/* For each k we maintain a novelty table that stores seen atom-combinations of size k */
+	struct noveltyTable **rts = (struct noveltyTable**)calloc(wmax + 1, sizeof(*rts));
     assert(rts);
 
-    int dequeued_total = 0;
-    int enqueued_total = 0;
-    int duplicated_total = 0;     /* số node bị loại do “không novel” */
-    char *soln = NULL;
-    int solved_w = 0;
+	/* Scratch state nodes are loaded into, moved by the selected backend */
+	gate_t *state = duplicate_state(start);
+	struct searchEngine *engine = newSearchEngine(state, options->backend);
 
-    double start = now();
+	/* Queue of nodes, one arena reused by every width */
+	struct arena *queue = newArena(sizeof(struct node));
+
+    char *soln = NULL;
+    bool stopped = false;
 
 	/* Iterate width from 1 to wmax */
-	for (int w = 1; w <= wmax; ++w) {
+	for (int w = 1; w <= wmax && !stopped; ++w) {
 
-		/* Create novelty trees for all k <= w if they don't exist yet */
-		for (int k = 1; k <= w; ++k) {
-			if (!rts[k]) rts[k] = getNewRadixTree(init_data->num_pieces, height, width);
+		/* Create novelty tables for all k <= w if they don't exist yet */
+		for (int k = 1; k <= w && k <= kmax; ++k) {
+			if (!rts[k]) rts[k] = newNoveltyTable(start->num_pieces, height, width, k);
 		}
 
-		/* Dynamic queue */
-        int qcap = 1024, qhead = 0, qtail = 0;
-        gate_t **queue = (gate_t**)malloc(sizeof(gate_t*) * qcap);
+		/* Restart the queue, releasing the previous width's nodes at once */
+        int qhead = 0;
+        resetArena(queue);
 
-		/* Load root (initial state copy) */
-        gate_t *root = duplicate_state(init_data);
-		free(root->soln);
-		root->soln = NULL;
-        if (!root->soln) { root->soln = (char*)malloc(1); root->soln[0] = '\0'; }
+		/* Load root (initial state) */
+        struct node root;
+        stateToNode(start, &root);
 
         memset(packedMap, 0, packedBytes);
-        packMap(root, packedMap);
-		/* Insert root into all novelty levels k where it is not present */
-		for (int k = 1; k <= w; ++k) {
-			if (checkPresentnCr(rts[k], packedMap, k) == NOTPRESENT) {
-				insertRadixTreenCr(rts[k], packedMap, k);
-			}
-		}
+        packMap(start, packedMap);
+		/* Insert root into all novelty levels k */
+		int kw = (w < kmax) ? w : kmax;
+		evaluateNovelty(rts, kw, packedMap);
 
-        queue[qtail++] = root;
+        enqueueNode(queue, &root);
         int dequeued = 0, enqueued = 1, duplicated = 0;
         int found = 0;
 
-        while (qhead < qtail) {
-            gate_t *u = queue[qhead++]; dequeued++;
-
-            if (winning_state(*u)) {
-                size_t L = strlen(u->soln);
-                soln = (char*)malloc(L + 1);
-                memcpy(soln, u->soln, L + 1);
-                free_state(u, init_data);
-                found = 1; solved_w = w;
+        while (qhead < queue->count) {
+            if (control && dequeued % CONTROLINTERVAL == 0) {
+                int memoryUsage = queryArenaMemoryUsage(queue);
+                for (int k = 1; k <= kw; ++k) memoryUsage += queryNoveltyMemoryUsage(rts[k]);
+                if (!searchMayContinue(control, memoryUsage)) {
+                    stopped = true;
+                    break;
+                }
+            }
+            int ui = qhead++; dequeued++;
+            /* Nodes never move once allocated */
+            struct node *u = (struct node *) arenaGet(queue, ui);
+            engineLoad(engine, u);
+
+            if (iwGoalReached(state, goal)) {
+                soln = buildSolution(queue, ui);
+                found = 1;
+                if (w > stats->width) stats->width = w;
                 break;
             }
 
 				/* Generate children: iterate pieces then {u,d,l,r} */
-            for (int p = 0; p < init_data->num_pieces; ++p) {
-                char piece = pieceNames[p];
+            for (int p = 0; p < start->num_pieces; ++p) {
                 for (int di = 0; di < 4; ++di) {
                     char dir = directions[di];
 
-                    gate_t moved = move_location(*u, piece, dir);
-
-						/* Non-move: piece p coordinates unchanged */
-						if (moved.piece_x[p] == u->piece_x[p] &&
-							moved.piece_y[p] == u->piece_y[p]) {
+						/* Non-move: piece p cannot move that way */
+						if (!engineMove(engine, p, dir)) {
 							continue;
 						}
 
-                    gate_t *child = duplicate_state(&moved);
-					free(child->soln);
-					child->soln = NULL;
-                    append_move(child, u->soln, piece, dir);
-
                     memset(packedMap, 0, packedBytes);
-                    packMap(child, packedMap);
+                    packMap(state, packedMap);
+                    struct node v;
+                    stateToNode(state, &v);
+                    /* Take the move back, restoring the scratch state for the next move */
+                    engineUndo(engine);
 
 					/* Novelty check: is there a k <= w such that some nCr combination
 					   of size k has NOT been seen? If none, the node is not novel and
-					   can be pruned. */
-					int novel_k = 0;
-					for (int k = 1; k <= w; ++k) {
-						if (checkPresentnCr(rts[k], packedMap, k) == NOTPRESENT) {
-							novel_k = k; break;
-						}
-					}
+					   can be pruned. The new combinations of every size are recorded
+					   in the same pass. */
+					int novel_k = evaluateNovelty(rts, kw, packedMap);
+					stats->noveltyHistogram[novel_k]++;
 					if (!novel_k) {
 						/* Not novel for any k <= w: prune this child */
 						duplicated++;
-						free_state(child, init_data);
 						continue;
 					}
 
-                    /* Insert vào cây tại kích thước novel_k */
-                    insertRadixTreenCr(rts[novel_k], packedMap, novel_k);
-
 					/* Enqueue the novel child */
-                    if (qtail >= qcap) {
-                        qcap *= 2;
-                        queue = (gate_t**)realloc(queue, sizeof(gate_t*) * qcap);
-                    }
-                    queue[qtail++] = child; enqueued++;
+                    v.parent = ui;
+                    v.move = ENCODEMOVE(p, di);
+                    enqueueNode(queue, &v); enqueued++;
                 }
             }
-
-			free_state(u, init_data);
         }
 
-		/* Clean up remaining queue entries if search broke due to finding a solution */
-		for (int i = qhead; i < qtail; ++i) if (queue[i]) free_state(queue[i], init_data);
-        free(queue);
-
-        dequeued_total   += dequeued;
-        enqueued_total   += enqueued;
-        duplicated_total += duplicated;
+        stats->dequeued   += dequeued;
+        stats->enqueued   += enqueued;
+        stats->duplicated += duplicated;
 
 		if (found) break; /* solution found at width w */
     }
 
-	/* Memory statistics for novelty trees */
-    int memoryUsage = 0;
+	freeSearchEngine(engine);
+	free_state(state, start);
+
+	/* Memory statistics for the node arena and novelty tables */
+    int memoryUsage = queryArenaMemoryUsage(queue);
+    freeArena(queue);
     for (int k = 1; k <= wmax; ++k) {
         if (rts[k]) {
-            memoryUsage += queryRadixMemoryUsage(rts[k]);
-            freeRadixTree(rts[k]);
+            memoryUsage += queryNoveltyMemoryUsage(rts[k]);
+            freeNoveltyTable(rts[k]);
         }
     }
+    if (memoryUsage > stats->memory) stats->memory = memoryUsage;
     free(rts);
     free(packedMap);
+    return soln;
+}
+
+void find_solution_algorithm3(gate_t* init_data, struct solverOptions *options) {
+	 /*
+	  * Algorithm 3: Iterative Width (IW) / novelty-based search
+	  * - Purpose: Perform a novelty-driven breadth-first search with increasing
+	  *   width (w). For each width, nodes are kept if they introduce a novel
+	  *   combination of atom-values (nCr of size k) for some k <= w.
+	  * - Inputs: `init_data` (initial puzzle state)
+	  * - Outputs: assigns `init_data->soln` to the found solution string.
+	  * - Notes: This method stores a novelty table for each k to record seen
+	  *   combinations (bitsets for k = 1 and 2, a radix tree for larger k)
+	  *   and prunes nodes that are not novel up to width w. Every new
+	  *   combination of size k <= w of a generated node is recorded. It is
+	  *   much more selective than plain BFS and can dramatically reduce search
+	  *   effort for many domains. Combinations larger than the number of
+	  *   pieces do not exist, so k never exceeds num_pieces.
+	  */
+    struct searchStats stats = {0};
+    stats.noveltyHistogram = (int *) calloc(init_data->num_pieces + 1, sizeof(int));
+    assert(stats.noveltyHistogram);
+    /* The whole goal: piece 0 covering every goal cell */
+    struct iwGoal goal = {NULL, 0, init_data->board->num_goals};
 
+    double start = now();
+    char *soln = iteratedWidth(init_data, options, &goal, init_data->num_pieces + 1, NULL, &stats);
     double elapsed = now() - start;
 
     /* In thống kê theo format của bạn */
-    printf("Solution path: %s\n", soln ? soln : "Not Found");
-    printf("Execution time: %lf\n", elapsed);
-    printf("Expanded nodes: %d\n", dequeued_total);
-    printf("Generated nodes: %d\n", enqueued_total);
-    printf("Duplicated nodes: %d\n", duplicated_total);
-    printf("Auxiliary memory usage (bytes): %d\n", memoryUsage);
-    printf("Number of pieces in the puzzle: %d\n", init_data->num_pieces);
-    printf("Number of steps in solution: %ld\n", soln ? (long)strlen(soln)/2 : 0L);
-
-    int emptySpaces = 0;
-    for (int i = 0; i < init_data->lines; ++i)
-        for (int j = 0; init_data->map_save[i][j] != '\0'; ++j)
-            if (init_data->map_save[i][j] == ' ') emptySpaces++;
-    printf("Number of empty spaces: %d\n", emptySpaces);
-
-    printf("Solved by IW(%d)\n", solved_w ? solved_w : (init_data->num_pieces + 1));
-    printf("Number of nodes expanded per second: %lf\n", (dequeued_total + 1) / elapsed);
+    printSearchStats(init_data, soln, elapsed, &stats);
+    free(stats.noveltyHistogram);
 
     if (soln) {
         init_data->soln = soln;   /* giao lại cho caller để free sau */
@@ -670,14 +1244,630 @@ void find_solution_algorithm3(gate_t* init_data) {
 	free_initial_state(init_data);
 }
 
+/* Goal cells covered by piece 0 in state, written to cells, returning how many. */
+static int coveredGoals(gate_t *state, int *cells) {
+	board_t const *board = state->board;
+	int anchor = state->piece_y[0] * board->columns + state->piece_x[0];
+	int count = 0;
+	for (int k = 0; k < board->footprint_size[0]; k++) {
+		int cell = anchor + board->footprint[0][k];
+		if (board->cells[cell] == 'G') {
+			cells[count++] = cell;
+		}
+	}
+	return count;
+}
+
+/*
+	Cuts the cycles out of plan, played from start: wherever the plan comes
+	back to a state it has been in, the moves in between are dropped. Returns
+	the shortened plan in a new string.
+*/
+static char *removeLoops(gate_t *start, char const *plan) {
+	int steps = strlen(plan) / 2;
+	int keyBytes = (getPackedSize(start) + 7) / 8;
+	unsigned char *keys = (unsigned char *) calloc((size_t) (steps + 1) * keyBytes, 1);
+	assert(keys);
+	gate_t *state = duplicate_state(start);
+	packMap(state, keys);
+	for (int i = 0; i < steps; i++) {
+		move_piece(state, plan[i * 2] - '0', plan[i * 2 + 1]);
+		packMap(state, keys + (size_t) (i + 1) * keyBytes);
+	}
+	free_state(state, start);
+
+	char *shortened = (char *) malloc(steps * 2 + 1);
+	assert(shortened);
+	int length = 0;
+	int i = 0;
+	while (i < steps) {
+		/* Jump to the last time the plan is in state i */
+		for (int j = steps; j > i; j--) {
+			if (memcmp(keys + (size_t) i * keyBytes, keys + (size_t) j * keyBytes, keyBytes) == 0) {
+				i = j;
+				break;
+			}
+		}
+		if (i == steps) {
+			break;
+		}
+		shortened[length++] = plan[i * 2];
+		shortened[length++] = plan[i * 2 + 1];
+		i++;
+	}
+	shortened[length] = '\0';
+	free(keys);
+	return shortened;
+}
+
+/*
+ * Serialized iterated width (SIW)
+ * - Purpose: Solve puzzles whose whole goal needs a high width by splitting
+ *   it into goal cells. Each IW run only has to get piece 0 onto one more
+ *   goal cell while still covering those already covered, then the next run
+ *   starts from the state it reached.
+ * - Inputs: `init_data` (initial puzzle state)
+ * - Outputs: assigns `init_data->soln` to the joined plans.
+ * - Notes: Each run builds its own novelty tables. The puzzle is reversible,
+ *   so every subgoal of a solvable puzzle can be reached, at worst at width
+ *   num_pieces + 1. The joined plan is not shortest; with options->shorten
+ *   the states it revisits are cut out of it.
+ */
+void find_solution_siw(gate_t* init_data, struct solverOptions *options) {
+	struct searchStats stats = {0};
+	stats.noveltyHistogram = (int *) calloc(init_data->num_pieces + 1, sizeof(int));
+	assert(stats.noveltyHistogram);
+	board_t const *board = init_data->board;
+	int kept[MAX_CELLS];
+	int subgoals = 0;
+
+	double start = now();
+	/* State reached by the plan so far */
+	gate_t *current = duplicate_state(init_data);
+	int keptCount = coveredGoals(current, kept);
+	char *soln = (char *) calloc(1, 1);
+	assert(soln);
+	while (soln && keptCount < board->num_goals) {
+		struct iwGoal goal = {kept, keptCount, keptCount + 1};
+		char *segment = iteratedWidth(current, options, &goal, init_data->num_pieces + 1, NULL, &stats);
+		if (!segment) {
+			free(soln);
+			soln = NULL;
+			break;
+		}
+		subgoals++;
+		int length = strlen(soln);
+		int added = strlen(segment);
+		soln = (char *) realloc(soln, length + added + 1);
+		assert(soln);
+		memcpy(soln + length, segment, added + 1);
+		for (int i = 0; i < added; i += 2) {
+			move_piece(current, segment[i] - '0', segment[i + 1]);
+		}
+		free(segment);
+		keptCount = coveredGoals(current, kept);
+	}
+	free_state(current, init_data);
+	if (soln && options->shorten) {
+		char *shortened = removeLoops(init_data, soln);
+		free(soln);
+		soln = shortened;
+	}
+	double elapsed = now() - start;
+
+	printSearchStats(init_data, soln, elapsed, &stats);
+	printf("Number of subgoals: %d\n", subgoals);
+	free(stats.noveltyHistogram);
+
+	if (soln) {
+		init_data->soln = soln;
+	}
+	free_initial_state(init_data);
+}
+
+/* Auxiliary memory of the A* search. */
+static int aStarMemory(struct radixTree *closed, struct arena *nodes, struct arena *costs,
+	struct bucketQueue *open, int cells) {
+	int memoryUsage = queryRadixMemoryUsage(closed);
+	memoryUsage += queryArenaMemoryUsage(nodes);
+	memoryUsage += queryArenaMemoryUsage(costs);
+	memoryUsage += queryBucketQueueMemoryUsage(open);
+	memoryUsage += cells * sizeof(int);
+	return memoryUsage;
+}
+
+/*
+ * A* search, under control if not NULL. Returns the solution, or NULL if
+ * there is none or the search was stopped, and fills stats.
+ */
+static char *aStar(gate_t* init_data, struct solverOptions *options,
+	struct searchControl *control, struct searchStats *stats) {
+	int packedBytes = getPackedSize(init_data);
+	int dequeued = 0;
+	int enqueued = 0;
+	int duplicatedNodes = 0;
+	char *soln = NULL;
+
+	int height = init_data->lines;
+	int width = init_data->num_chars_map / init_data->lines;
+	int atomCount = init_data->num_pieces;
+	int columns = init_data->board->columns;
+	int *goalDistance = newGoalDistances(init_data->board);
+	/* Expanded states */
+	struct radixTree *closed = getNewRadixTree(atomCount, height, width);
+	unsigned char *packed = (unsigned char*)calloc(packedBytes, sizeof(unsigned char));
+	assert(packed);
+	/* Scratch state nodes are loaded into, moved by the selected backend */
+	gate_t *state = duplicate_state(init_data);
+	struct searchEngine *engine = newSearchEngine(state, options->backend);
+	/* Nodes, and the number of moves to each, allocated in slabs */
+	struct arena *nodes = newArena(sizeof(struct node));
+	struct arena *costs = newArena(sizeof(int));
+	struct bucketQueue *open = newBucketQueue();
+
+	int rootH = goalDistance[init_data->piece_y[0] * columns + init_data->piece_x[0]];
+	if (rootH != GOALUNREACHABLE) {
+		struct node root;
+		stateToNode(init_data, &root);
+		int ri = enqueueNode(nodes, &root);
+		*(int *) arenaGet(costs, arenaAlloc(costs)) = 0;
+		bucketPush(open, rootH, ri);
+		enqueued++;
+	}
+	int f;
+	int ui;
+	while (bucketPop(open, &f, &ui)) {
+		/* Nodes never move once allocated */
+		struct node *u = (struct node *) arenaGet(nodes, ui);
+		int g = *(int *) arenaGet(costs, ui);
+		engineLoad(engine, u);
+		packMap(state, packed);
+		if (insertIfAbsent(closed, packed, atomCount) == PRESENT) {
+			/* Already expanded through a path at least as short */
+			duplicatedNodes++;
+			continue;
+		}
+		dequeued++;
+		if (control && dequeued % CONTROLINTERVAL == 0
+			&& !searchMayContinue(control, aStarMemory(closed, nodes, costs, open, height * width))) {
+			break;
+		}
+		if (engineWon(engine)) {
+			soln = buildSolution(nodes, ui);
+			break;
+		}
+		for (int p = 0; p < init_data->num_pieces; p++) {
+			for (int d = 0; d < 4; d++) {
+				if (!engineMove(engine, p, directions[d])) {
+					continue;
+				}
+				int h = goalDistance[state->piece_y[0] * columns + state->piece_x[0]];
+				packMap(state, packed);
+				struct node v;
+				stateToNode(state, &v);
+				engineUndo(engine);
+				if (h == GOALUNREACHABLE) {
+					continue;
+				}
+				if (checkPresent(closed, packed, atomCount) == PRESENT) {
+					duplicatedNodes++;
+					continue;
+				}
+				v.parent = ui;
+				v.move = ENCODEMOVE(p, d);
+				int vi = enqueueNode(nodes, &v);
+				*(int *) arenaGet(costs, arenaAlloc(costs)) = g + 1;
+				bucketPush(open, g + 1 + h, vi);
+				enqueued++;
+			}
+		}
+	}
+
+	stats->dequeued = dequeued;
+	stats->enqueued = enqueued;
+	stats->duplicated = duplicatedNodes;
+	stats->memory = aStarMemory(closed, nodes, costs, open, height * width);
+
+	freeBucketQueue(open);
+	freeArena(costs);
+	freeArena(nodes);
+	freeSearchEngine(engine);
+	free_state(state, init_data);
+	freeRadixTree(closed);
+	free(packed);
+	freeGoalDistances(goalDistance);
+	return soln;
+}
+
+/*
+ * Algorithm 4: A* with a goal-distance heuristic
+ * - Purpose: Find the shortest solution while expanding far fewer states
+ *   than BFS, by expanding states in order of f = g + h, where g is the
+ *   number of moves made and h the fewest moves piece 0 needs to cover every
+ *   goal with only the walls in place (see heuristic.h).
+ * - Inputs: `init_data` (initial puzzle state)
+ * - Outputs: assigns `init_data->soln` to the found solution string.
+ * - Notes: h never overestimates and changes by at most one per move, so the
+ *   first time a state is taken off the open list it has its shortest g. The
+ *   open list is a bucket queue on f; a state may be on it more than once,
+ *   copies taken off after the first are counted as duplicates. Expanded
+ *   states are kept in a radix tree. States from which piece 0 can never
+ *   reach the goals are not generated.
+ */
+void find_solution_astar(gate_t* init_data, struct solverOptions *options) {
+	struct searchStats stats = {0};
+	double start = now();
+	char *soln = aStar(init_data, options, NULL, &stats);
+	double elapsed = now() - start;
+	printSearchStats(init_data, soln, elapsed, &stats);
+
+	if (soln) {
+		init_data->soln = soln;
+	}
+	free_initial_state(init_data);
+}
+
+/* Largest tuple size BFWS measures novelty over, larger is counted as BFWSWIDTH + 1. */
+#define BFWSWIDTH 2
+
+/* Auxiliary memory of the best-first width search. */
+static int bestFirstWidthMemory(struct radixTree *seen, struct arena *nodes,
+	struct arena *depths, struct bucketQueue **open, int classCount,
+	struct noveltyTable ***partitions, int goalClasses, int w) {
+	int memoryUsage = queryRadixMemoryUsage(seen);
+	memoryUsage += queryArenaMemoryUsage(nodes);
+	memoryUsage += queryArenaMemoryUsage(depths);
+	for (int c = 0; c < classCount; c++) {
+		memoryUsage += queryBucketQueueMemoryUsage(open[c]);
+	}
+	for (int g = 0; g < goalClasses; g++) {
+		for (int k = 1; partitions[g] && k <= w; k++) {
+			memoryUsage += queryNoveltyMemoryUsage(partitions[g][k]);
+		}
+	}
+	return memoryUsage;
+}
+
+/*
+ * Best-first width search, under control if not NULL. Returns the solution,
+ * or NULL if there is none or the search was stopped, and fills stats.
+ */
+static char *bestFirstWidth(gate_t* init_data, struct solverOptions *options,
+	struct searchControl *control, struct searchStats *stats) {
+	int packedBytes = getPackedSize(init_data);
+	int dequeued = 0;
+	int enqueued = 0;
+	int duplicatedNodes = 0;
+	char *soln = NULL;
+
+	int height = init_data->lines;
+	int width = init_data->num_chars_map / init_data->lines;
+	int atomCount = init_data->num_pieces;
+	int goalClasses = init_data->board->num_goals + 1;
+	int w = (atomCount < BFWSWIDTH) ? atomCount : BFWSWIDTH;
+	/* Novelty tables of sizes 1 to w for each number of open goals, made on first use */
+	struct noveltyTable ***partitions = (struct noveltyTable ***) calloc(goalClasses, sizeof(*partitions));
+	assert(partitions);
+	struct radixTree *seen = getNewRadixTree(atomCount, height, width);
+	unsigned char *packed = (unsigned char*)calloc(packedBytes, sizeof(unsigned char));
+	assert(packed);
+	/* Scratch state nodes are loaded into, moved by the selected backend */
+	gate_t *state = duplicate_state(init_data);
+	struct searchEngine *engine = newSearchEngine(state, options->backend);
+	struct arena *nodes = newArena(sizeof(struct node));
+	struct arena *depths = newArena(sizeof(int));
+	/* Open list, class (novelty - 1) * goalClasses + open goals */
+	int classCount = (w + 1) * goalClasses;
+	struct bucketQueue **open = (struct bucketQueue **) malloc(classCount * sizeof(*open));
+	assert(open);
+	for (int c = 0; c < classCount; c++) {
+		open[c] = newBucketQueue();
+	}
+	/* No class below this one holds nodes */
+	int lowestClass = 0;
+
+	struct node root;
+	stateToNode(init_data, &root);
+	packMap(init_data, packed);
+	insertIfAbsent(seen, packed, atomCount);
+	int rootGoals = init_data->goals_open;
+	partitions[rootGoals] = (struct noveltyTable **) calloc(w + 1, sizeof(struct noveltyTable *));
+	assert(partitions[rootGoals]);
+	for (int k = 1; k <= w; k++) {
+		partitions[rootGoals][k] = newNoveltyTable(atomCount, height, width, k);
+	}
+	evaluateNovelty(partitions[rootGoals], w, packed);
+	int ri = enqueueNode(nodes, &root);
+	*(int *) arenaGet(depths, arenaAlloc(depths)) = 0;
+	bucketPush(open[rootGoals], 0, ri);
+	enqueued++;
+
+	while (lowestClass < classCount) {
+		int depth;
+		int ui;
+		if (!bucketPop(open[lowestClass], &depth, &ui)) {
+			lowestClass++;
+			continue;
+		}
+		dequeued++;
+		if (control && dequeued % CONTROLINTERVAL == 0
+			&& !searchMayContinue(control, bestFirstWidthMemory(seen, nodes, depths,
+				open, classCount, partitions, goalClasses, w))) {
+			break;
+		}
+		/* Nodes never move once allocated */
+		struct node *u = (struct node *) arenaGet(nodes, ui);
+		engineLoad(engine, u);
+		if (engineWon(engine)) {
+			soln = buildSolution(nodes, ui);
+			break;
+		}
+		for (int p = 0; p < init_data->num_pieces; p++) {
+			for (int d = 0; d < 4; d++) {
+				if (!engineMove(engine, p, directions[d])) {
+					continue;
+				}
+				int goalsOpen = engineGoalsOpen(engine);
+				packMap(state, packed);
+				struct node v;
+				stateToNode(state, &v);
+				engineUndo(engine);
+				if (insertIfAbsent(seen, packed, atomCount) == PRESENT) {
+					duplicatedNodes++;
+					continue;
+				}
+				struct noveltyTable **tables = partitions[goalsOpen];
+				if (!tables) {
+					tables = (struct noveltyTable **) calloc(w + 1, sizeof(struct noveltyTable *));
+					assert(tables);
+					for (int k = 1; k <= w; k++) {
+						tables[k] = newNoveltyTable(atomCount, height, width, k);
+					}
+					partitions[goalsOpen] = tables;
+				}
+				int novelty = evaluateNovelty(tables, w, packed);
+				if (stats->noveltyHistogram) {
+					stats->noveltyHistogram[novelty]++;
+				}
+				if (!novelty) {
+					novelty = w + 1;
+				}
+				v.parent = ui;
+				v.move = ENCODEMOVE(p, d);
+				int vi = enqueueNode(nodes, &v);
+				*(int *) arenaGet(depths, arenaAlloc(depths)) = depth + 1;
+				int c = (novelty - 1) * goalClasses + goalsOpen;
+				bucketPush(open[c], depth + 1, vi);
+				if (c < lowestClass) {
+					lowestClass = c;
+				}
+				enqueued++;
+			}
+		}
+	}
+
+	stats->dequeued = dequeued;
+	stats->enqueued = enqueued;
+	stats->duplicated = duplicatedNodes;
+	stats->memory = bestFirstWidthMemory(seen, nodes, depths, open, classCount,
+		partitions, goalClasses, w);
+
+	for (int c = 0; c < classCount; c++) {
+		freeBucketQueue(open[c]);
+	}
+	free(open);
+	for (int g = 0; g < goalClasses; g++) {
+		if (!partitions[g]) {
+			continue;
+		}
+		for (int k = 1; k <= w; k++) {
+			freeNoveltyTable(partitions[g][k]);
+		}
+		free(partitions[g]);
+	}
+	free(partitions);
+	freeArena(depths);
+	freeArena(nodes);
+	freeSearchEngine(engine);
+	free_state(state, init_data);
+	freeRadixTree(seen);
+	free(packed);
+	return soln;
+}
+
+/*
+ * Best-first width search (BFWS)
+ * - Purpose: Combine novelty with progress towards the goal in one search
+ *   instead of IW's restarts at increasing width. States are expanded in
+ *   order of (novelty, goal cells left open, depth).
+ * - Inputs: `init_data` (initial puzzle state)
+ * - Outputs: assigns `init_data->soln` to the found solution string.
+ * - Notes: Novelty is measured among the states with the same number of open
+ *   goals, with a pair of novelty tables (sizes 1 and 2) per goal count, so
+ *   covering a new goal cell starts the count afresh. A state with no new 
+ *   atom or pair has novelty BFWSWIDTH + 1; it is kept, only behind the 
+ *   novel states. Seen states are kept in a radix tree, so every state is 
+ *   generated once and the search is complete, though not shortest. The 
+ *   open list holds one bucket queue on depth per (novelty, open goals) 
+ *   class.
+ */
+void find_solution_bfws(gate_t* init_data, struct solverOptions *options) {
+	struct searchStats stats = {0};
+	stats.noveltyHistogram = (int *) calloc(init_data->num_pieces + 1, sizeof(int));
+	assert(stats.noveltyHistogram);
+	double start = now();
+	char *soln = bestFirstWidth(init_data, options, NULL, &stats);
+	double elapsed = now() - start;
+	printSearchStats(init_data, soln, elapsed, &stats);
+	free(stats.noveltyHistogram);
+
+	if (soln) {
+		init_data->soln = soln;
+	}
+	free_initial_state(init_data);
+}
+
+/* Kinds of search a portfolio runs. */
+#define PORTFOLIOIW 0
+#define PORTFOLIOBFS 1
+#define PORTFOLIOASTAR 2
+#define PORTFOLIOBFWS 3
+
+/* One search of a portfolio, run on its own thread. */
+struct portfolioRun {
+	char const *name;
+	int kind;
+	/* Largest width, for PORTFOLIOIW */
+	int width;
+	pthread_t thread;
+	gate_t *init_data;
+	struct solverOptions *options;
+	struct searchControl control;
+	struct searchStats stats;
+	char *soln;
+	/* Index of the first run to find a solution, -1 until one does */
+	int *winner;
+	int index;
+};
+
+static void *portfolioSearch(void *arg) {
+	struct portfolioRun *run = (struct portfolioRun *) arg;
+	gate_t *init_data = run->init_data;
+	struct iwGoal goal = {NULL, 0, init_data->board->num_goals};
+	switch (run->kind) {
+	case PORTFOLIOIW:
+		run->soln = iteratedWidth(init_data, run->options, &goal, run->width,
+			&run->control, &run->stats);
+		break;
+	case PORTFOLIOASTAR:
+		run->soln = aStar(init_data, run->options, &run->control, &run->stats);
+		break;
+	case PORTFOLIOBFWS:
+		run->soln = bestFirstWidth(init_data, run->options, &run->control, &run->stats);
+		break;
+	default:
+		run->soln = breadthFirst(init_data, run->options, &run->control, &run->stats);
+		break;
+	}
+	int none = -1;
+	if (run->soln && __atomic_compare_exchange_n(run->winner, &none, run->index,
+		false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		/* First to finish, the others stop at their next check */
+		__atomic_store_n(run->control.cancel, 1, __ATOMIC_RELAXED);
+	}
+	return NULL;
+}
+
+/*
+ * Portfolio
+ * - Purpose: Get the fastest of several searches without knowing which
+ *   suits the puzzle, by running IW(1), IW(2), algorithm 2, A* and BFWS 
+ *   side by side, one thread each.
+ * - Inputs: `init_data` (initial puzzle state)
+ * - Outputs: assigns `init_data->soln` to the first solution found.
+ * - Notes: The first search to find a solution wins and sets a shared flag
+ *   the others check every CONTROLINTERVAL expansions, so they stop
+ *   cooperatively. Each search has its own budget of 
+ *   options->memoryBudget bytes of auxiliary memory, and gives up when it
+ *   goes over. The stats block is the winner's, followed by the winner and
+ *   how every search ended. Which search wins can vary from run to run when
+ *   two are close.
+ */
+void find_solution_portfolio(gate_t* init_data, struct solverOptions *options) {
+	struct portfolioRun runs[] = {
+		{ .name = "IW(1)", .kind = PORTFOLIOIW, .width = 1 },
+		{ .name = "IW(2)", .kind = PORTFOLIOIW, .width = 2 },
+		{ .name = "BFS", .kind = PORTFOLIOBFS },
+		{ .name = "A*", .kind = PORTFOLIOASTAR },
+		{ .name = "BFWS", .kind = PORTFOLIOBFWS },
+	};
+	int runCount = sizeof(runs) / sizeof(runs[0]);
+	int cancel = 0;
+	int winner = -1;
+	double start = now();
+	for (int r = 0; r < runCount; r++) {
+		runs[r].init_data = init_data;
+		runs[r].options = options;
+		runs[r].control.cancel = &cancel;
+		runs[r].control.memoryBudget = options->memoryBudget;
+		runs[r].winner = &winner;
+		runs[r].index = r;
+		if (runs[r].kind == PORTFOLIOIW || runs[r].kind == PORTFOLIOBFWS) {
+			runs[r].stats.noveltyHistogram = (int *) calloc(init_data->num_pieces + 1, sizeof(int));
+			assert(runs[r].stats.noveltyHistogram);
+		}
+		pthread_create(&runs[r].thread, NULL, portfolioSearch, &runs[r]);
+	}
+	for (int r = 0; r < runCount; r++) {
+		pthread_join(runs[r].thread, NULL);
+	}
+	double elapsed = now() - start;
+
+	char *soln = NULL;
+	if (winner >= 0) {
+		soln = runs[winner].soln;
+		printSearchStats(init_data, soln, elapsed, &runs[winner].stats);
+		printf("Portfolio winner: %s\n", runs[winner].name);
+	} else {
+		struct searchStats none = {0};
+		printSearchStats(init_data, NULL, elapsed, &none);
+		printf("Portfolio winner: none\n");
+	}
+	for (int r = 0; r < runCount; r++) {
+		char const *outcome = "no solution";
+		if (r == winner) {
+			outcome = "won";
+		} else if (runs[r].soln) {
+			outcome = "solved after the winner";
+		} else if (runs[r].control.overBudget) {
+			outcome = "over memory budget";
+		} else if (runs[r].control.cancelled) {
+			outcome = "cancelled";
+		}
+		printf("Portfolio %s: %s, %d expanded\n", runs[r].name, outcome, runs[r].stats.dequeued);
+		if (r != winner) {
+			free(runs[r].soln);
+		}
+		free(runs[r].stats.noveltyHistogram);
+	}
+
+	if (soln) {
+		init_data->soln = soln;
+	}
+	free_initial_state(init_data);
+}
+
 /**
  * Find a solution by exploring all possible paths
  */
-void find_solution(gate_t* init_data)
+void find_solution(gate_t* init_data, struct solverOptions *options)
 {
-	//find_solution_algorithm1(init_data);
-	find_solution_algorithm2(init_data);
-	//find_solution_algorithm3(init_data);
+	switch (options->algorithm) {
+	case ALGORITHM_PLAIN:
+		find_solution_algorithm1(init_data, options);
+		break;
+	case ALGORITHM_IW:
+		find_solution_algorithm3(init_data, options);
+		break;
+	case ALGORITHM_ASTAR:
+		find_solution_astar(init_data, options);
+		break;
+	case ALGORITHM_SIW:
+		find_solution_siw(init_data, options);
+		break;
+	case ALGORITHM_BFWS:
+		find_solution_bfws(init_data, options);
+		break;
+	case ALGORITHM_PARALLEL:
+		find_solution_parallel(init_data, options);
+		break;
+	case ALGORITHM_PORTFOLIO:
+		find_solution_portfolio(init_data, options);
+		break;
+	default:
+		find_solution_algorithm2(init_data, options);
+		break;
+	}
 }
 /**
  * Given a game state, work out the number of bytes required to store the state.
@@ -728,20 +1918,50 @@ void packMap(gate_t *gate, unsigned char *packedMap) {
 }
 
 /**
- * Check if the given state is in a won state.
- */
-bool winning_state(gate_t gate) {
-	for (int i = 0; i < gate.lines; i++) {
-		for (int j = 0; gate.map_save[i][j] != '\0'; j++) {
-			if (gate.map[i][j] == 'G' || (gate.map[i][j] >= 'I' && gate.map[i][j] <= 'Q')) {
-				return false;
-			}
+ * Set the piece locations of the state from a map stored by packMap.
+*/
+void unpackMap(gate_t *gate, unsigned char *packedMap) {
+	int pBits = calcBits(gate->num_pieces);
+    int hBits = calcBits(gate->lines);
+    int wBits = calcBits(gate->num_chars_map / gate->lines);
+	int bitIdx = 0;
+	for(int i = 0; i < gate->num_pieces; i++) {
+		/* Pieces are stored in order, their index is not needed */
+		bitIdx += pBits;
+		gate->piece_y[i] = 0;
+		for(int j = 0; j < hBits; j++) {
+			gate->piece_y[i] |= getBit( packedMap, bitIdx ) << j;
+			bitIdx++;
+		}
+		gate->piece_x[i] = 0;
+		for(int j = 0; j < wBits; j++) {
+			gate->piece_x[i] |= getBit( packedMap, bitIdx ) << j;
+			bitIdx++;
 		}
 	}
-	return true;
+}
+
+void defaultSolverOptions(struct solverOptions *options) {
+	options->backend = BACKEND_MAP;
+	options->zobrist = ZOBRIST_OFF;
+	options->visited = VISITED_RADIX;
+	options->batch = false;
+	options->algorithm = ALGORITHM_BFS;
+	options->shorten = false;
+	options->threads = 0;
+	options->memoryBudget = 0;
+	options->saveVisited = NULL;
+	options->checkVisited = NULL;
 }
 
 void solve(char const *path)
+{
+	struct solverOptions options;
+	defaultSolverOptions(&options);
+	solveWithOptions(path, &options);
+}
+
+void solveWithOptions(char const *path, struct solverOptions *options)
 {
 	/**
 	 * Load Map
@@ -767,7 +1987,17 @@ void solve(char const *path)
 	/* Ensure initial soln pointer is initialized */
 	gate.soln = NULL;
 
-	find_solution(&gate);
+	/**
+	 * Precompute walls, goals and piece footprints shared by all states.
+	*/
+	gate.board = make_board(gate);
+	gate.goals_open = count_open_goals(gate.board, gate.piece_y[0], gate.piece_x[0]);
+	gate.hash = hash_pieces(gate.board, gate.piece_y, gate.piece_x);
+
+	find_solution(&gate, options);
+
+	free_board(gate.board);
+	gate.board = NULL;
 	
 	/* Free the solution string if it exists */
 	if (gate.soln) {
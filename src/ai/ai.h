@@ -3,7 +3,82 @@
 
 #include <stdint.h>
 #include <unistd.h>
+#include "engine.h"
+
+/* Search run by find_solution. */
+/* Algorithm 1, BFS without duplicate detection. */
+#define ALGORITHM_PLAIN 1
+/* Algorithm 2, BFS with duplicate detection. */
+#define ALGORITHM_BFS 2
+/* Algorithm 3, iterated width. */
+#define ALGORITHM_IW 3
+/* A* with the goal-distance heuristic of heuristic.h. */
+#define ALGORITHM_ASTAR 4
+/* Serialized iterated width, one IW run per goal cell. */
+#define ALGORITHM_SIW 5
+/* Best-first width search on novelty, open goals and depth. */
+#define ALGORITHM_BFWS 6
+/* Algorithm 2 run one layer at a time on several threads. */
+#define ALGORITHM_PARALLEL 7
+/* Several searches on their own threads, the first solution wins. */
+#define ALGORITHM_PORTFOLIO 8
+
+/* Use of Zobrist keys for duplicate detection in algorithm 2. */
+/* Radix tree only. */
+#define ZOBRIST_OFF 0
+/* Keys filter out new states, the visited set verifies repeated keys. */
+#define ZOBRIST_VERIFY 1
+/* Keys alone, a collision would wrongly prune a state. */
+#define ZOBRIST_TRUST 2
+
+/* Set of seen packed states used for duplicate detection in algorithm 2. */
+/* Bit-packed radix tree, compact. */
+#define VISITED_RADIX 0
+/* Open-addressing hash set (stateset.h), faster lookups for more memory. */
+#define VISITED_HASHSET 1
+/* Radix trees sharded by key hash with a lock each (sharded.h), thread-safe. */
+#define VISITED_SHARDED 2
+/* Shards of VISITED_SHARDED. */
+#define VISITEDSHARDS 64
+/* Most threads of ALGORITHM_PARALLEL, each owns at least one shard. */
+#define MAXTHREADS VISITEDSHARDS
+
+/* Options selecting how the solver searches. */
+struct solverOptions {
+    /* ALGORITHM_PLAIN, ALGORITHM_BFS, ALGORITHM_IW, ALGORITHM_ASTAR, 
+       ALGORITHM_SIW, ALGORITHM_BFWS, ALGORITHM_PARALLEL or 
+       ALGORITHM_PORTFOLIO. */
+    int algorithm;
+    /* Move engine backend, BACKEND_MAP or BACKEND_BITBOARD (see engine.h). */
+    int backend;
+    /* ZOBRIST_OFF, ZOBRIST_VERIFY or ZOBRIST_TRUST. */
+    int zobrist;
+    /* VISITED_RADIX, VISITED_HASHSET or VISITED_SHARDED. */
+    int visited;
+    /* Check the children of a BFS layer in one sorted batch (algorithm 2, 
+       needs zobrist == ZOBRIST_OFF). */
+    bool batch;
+    /* Cut the states it revisits out of the joined SIW plan. */
+    bool shorten;
+    /* Threads of ALGORITHM_PARALLEL, at most MAXTHREADS, 0 for one per
+       online processor. */
+    int threads;
+    /* Auxiliary memory in bytes each ALGORITHM_PORTFOLIO search may use, 0
+       for no limit. */
+    long memoryBudget;
+    /* File algorithm 2 saves its radix tree visited set to when done, or
+       NULL (see saveRadixTree). */
+    char const *saveVisited;
+    /* Snapshot of an earlier run algorithm 2 looks every expanded state up
+       in, or NULL (see loadRadixTree). */
+    char const *checkVisited;
+};
+
+/* Fills options with the defaults used by solve. */
+void defaultSolverOptions(struct solverOptions *options);
 
 void solve(char const *path);
 
+void solveWithOptions(char const *path, struct solverOptions *options);
+
 #endif
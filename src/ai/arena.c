@@ -0,0 +1,68 @@
+#include "arena.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#define INITIALSLABS 16
+
+struct arena *newArena(size_t recordSize) {
+    struct arena *arena = (struct arena *) malloc(sizeof(struct arena));
+    assert(arena);
+    arena->recordSize = recordSize;
+    arena->count = 0;
+    arena->slabCount = 0;
+    arena->slabCapacity = INITIALSLABS;
+    arena->slabs = (unsigned char **) malloc(sizeof(unsigned char *) * INITIALSLABS);
+    assert(arena->slabs);
+    return arena;
+}
+
+/* Adds a slab, only the slab table ever moves. */
+static void addSlab(struct arena *arena) {
+    if(arena->slabCount == arena->slabCapacity) {
+        arena->slabCapacity *= 2;
+        arena->slabs = (unsigned char **) realloc(arena->slabs, 
+            sizeof(unsigned char *) * arena->slabCapacity);
+        assert(arena->slabs);
+    }
+    arena->slabs[arena->slabCount] = (unsigned char *) malloc(arena->recordSize * ARENASLABRECORDS);
+    assert(arena->slabs[arena->slabCount]);
+    arena->slabCount++;
+}
+
+int arenaAlloc(struct arena *arena) {
+    int idx = arena->count;
+    if((idx >> ARENASLABBITS) >= arena->slabCount) {
+        addSlab(arena);
+    }
+    arena->count++;
+    return idx;
+}
+
+int arenaAllocRange(struct arena *arena, int count) {
+    int idx = arena->count;
+    int slabsNeeded = (idx + count + ARENASLABRECORDS - 1) >> ARENASLABBITS;
+    while(arena->slabCount < slabsNeeded) {
+        addSlab(arena);
+    }
+    arena->count += count;
+    return idx;
+}
+
+void resetArena(struct arena *arena) {
+    arena->count = 0;
+}
+
+int queryArenaMemoryUsage(struct arena *arena) {
+    return arena->slabCount * arena->recordSize * ARENASLABRECORDS;
+}
+
+void freeArena(struct arena *arena) {
+    if(! arena) {
+        return;
+    }
+    for(int i = 0; i < arena->slabCount; i++) {
+        free(arena->slabs[i]);
+    }
+    free(arena->slabs);
+    free(arena);
+}
@@ -0,0 +1,51 @@
+/*
+ * Arena of fixed-size records allocated in large slabs. Records are named by
+ * index, never move once allocated and are only released all at once by
+ * resetArena, which keeps the slabs for the next search generation.
+*/
+#ifndef __ARENA__
+#define __ARENA__
+
+#include <stddef.h>
+
+/* Records per slab, a power of two so indices split with shifts. */
+#define ARENASLABBITS 12
+#define ARENASLABRECORDS (1 << ARENASLABBITS)
+
+struct arena {
+    size_t recordSize;
+    /* Records handed out since the last reset. */
+    int count;
+    int slabCount;
+    int slabCapacity;
+    unsigned char **slabs;
+};
+
+/* Creates an empty arena for records of recordSize bytes. */
+struct arena *newArena(size_t recordSize);
+
+/* Allocates one record, returning its index. */
+int arenaAlloc(struct arena *arena);
+
+/* 
+    Allocates count consecutive records, returning the index of the first. 
+    Records in the range can then be filled by several threads at once.
+*/
+int arenaAllocRange(struct arena *arena, int count);
+
+/* Returns the record at index idx. */
+static inline void *arenaGet(struct arena *arena, int idx) {
+    return arena->slabs[idx >> ARENASLABBITS] 
+        + (size_t) (idx & (ARENASLABRECORDS - 1)) * arena->recordSize;
+}
+
+/* Releases every record in O(1), keeping the slabs for reuse. */
+void resetArena(struct arena *arena);
+
+/* Return memory held in slabs. */
+int queryArenaMemoryUsage(struct arena *arena);
+
+/* Free arena and all its slabs. */
+void freeArena(struct arena *arena);
+
+#endif
@@ -0,0 +1,93 @@
+#include "bucket.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#define INITIALBUCKETS 64
+#define INITIALBUCKETSIZE 16
+
+struct bucket {
+    int count;
+    int capacity;
+    int *values;
+};
+
+struct bucketQueue {
+    int bucketCount;
+    /* No bucket below this one holds values. */
+    int lowest;
+    int size;
+    struct bucket *buckets;
+};
+
+struct bucketQueue *newBucketQueue(void) {
+    struct bucketQueue *queue = (struct bucketQueue *) malloc(sizeof(struct bucketQueue));
+    assert(queue);
+    queue->bucketCount = INITIALBUCKETS;
+    queue->lowest = 0;
+    queue->size = 0;
+    queue->buckets = (struct bucket *) calloc(INITIALBUCKETS, sizeof(struct bucket));
+    assert(queue->buckets);
+    return queue;
+}
+
+void bucketPush(struct bucketQueue *queue, int priority, int value) {
+    assert(priority >= 0);
+    if(priority >= queue->bucketCount) {
+        int newCount = queue->bucketCount;
+        while(priority >= newCount) {
+            newCount *= 2;
+        }
+        queue->buckets = (struct bucket *) realloc(queue->buckets, sizeof(struct bucket) * newCount);
+        assert(queue->buckets);
+        for(int i = queue->bucketCount; i < newCount; i++) {
+            queue->buckets[i].count = 0;
+            queue->buckets[i].capacity = 0;
+            queue->buckets[i].values = NULL;
+        }
+        queue->bucketCount = newCount;
+    }
+    struct bucket *b = &queue->buckets[priority];
+    if(b->count == b->capacity) {
+        b->capacity = b->capacity ? b->capacity * 2 : INITIALBUCKETSIZE;
+        b->values = (int *) realloc(b->values, sizeof(int) * b->capacity);
+        assert(b->values);
+    }
+    b->values[b->count++] = value;
+    if(priority < queue->lowest) {
+        queue->lowest = priority;
+    }
+    queue->size++;
+}
+
+bool bucketPop(struct bucketQueue *queue, int *priority, int *value) {
+    if(queue->size == 0) {
+        return false;
+    }
+    while(queue->buckets[queue->lowest].count == 0) {
+        queue->lowest++;
+    }
+    struct bucket *b = &queue->buckets[queue->lowest];
+    *priority = queue->lowest;
+    *value = b->values[--b->count];
+    queue->size--;
+    return true;
+}
+
+int queryBucketQueueMemoryUsage(struct bucketQueue *queue) {
+    int memoryUsage = queue->bucketCount * sizeof(struct bucket);
+    for(int i = 0; i < queue->bucketCount; i++) {
+        memoryUsage += queue->buckets[i].capacity * sizeof(int);
+    }
+    return memoryUsage;
+}
+
+void freeBucketQueue(struct bucketQueue *queue) {
+    if(! queue) {
+        return;
+    }
+    for(int i = 0; i < queue->bucketCount; i++) {
+        free(queue->buckets[i].values);
+    }
+    free(queue->buckets);
+    free(queue);
+}
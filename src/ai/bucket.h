@@ -0,0 +1,32 @@
+/*
+ * Priority queue for small non-negative integer priorities, one stack of 
+ * values per priority. Push and pop are O(1) amortised, plus a scan over
+ * empty priorities which only moves forward when priorities never decrease.
+*/
+#ifndef __BUCKET__
+#define __BUCKET__
+
+#include <stdbool.h>
+
+struct bucketQueue;
+
+/* Creates an empty queue. */
+struct bucketQueue *newBucketQueue(void);
+
+/* Adds value with the given priority. */
+void bucketPush(struct bucketQueue *queue, int priority, int value);
+
+/* 
+	Removes a value of the lowest priority, the most recently pushed among 
+	equals, into value and its priority into priority. Returns false if the 
+	queue is empty.
+*/
+bool bucketPop(struct bucketQueue *queue, int *priority, int *value);
+
+/* Return memory held by the queue's buckets. */
+int queryBucketQueueMemoryUsage(struct bucketQueue *queue);
+
+/* Free queue */
+void freeBucketQueue(struct bucketQueue *queue);
+
+#endif
@@ -0,0 +1,93 @@
+#include "engine.h"
+#include <stdlib.h>
+#include <assert.h>
+
+/* Copies the anchor of piece from the bitboards into state, updating its key. */
+static void syncAnchor(struct searchEngine *engine, int piece) {
+    gate_t *state = engine->state;
+    int columns = engine->board->columns;
+    state->hash ^= engine->board->zobrist[piece][state->piece_y[piece] * columns + state->piece_x[piece]];
+    state->piece_x[piece] = engine->bits.piece_x[piece];
+    state->piece_y[piece] = engine->bits.piece_y[piece];
+    state->hash ^= engine->board->zobrist[piece][state->piece_y[piece] * columns + state->piece_x[piece]];
+}
+
+struct searchEngine *newSearchEngine(gate_t *state, int backend) {
+    struct searchEngine *engine = (struct searchEngine *) malloc(sizeof(struct searchEngine));
+    assert(engine);
+    engine->backend = backend;
+    engine->board = state->board;
+    engine->state = state;
+    if(backend == BACKEND_BITBOARD) {
+        bitstate_init(&engine->bits, engine->board);
+    }
+    return engine;
+}
+
+void engineLoad(struct searchEngine *engine, struct node *node) {
+    if(engine->backend == BACKEND_BITBOARD) {
+        for(int i = 0; i < MAX_PIECES; i++) {
+            engine->state->piece_x[i] = node->piece_x[i];
+            engine->state->piece_y[i] = node->piece_y[i];
+        }
+        bitstate_place(&engine->bits, engine->state->piece_x, engine->state->piece_y);
+        engine->state->hash = hash_pieces(engine->board, engine->state->piece_y, engine->state->piece_x);
+    } else {
+        nodeToState(engine->board, node, engine->state);
+    }
+}
+
+bool engineWon(struct searchEngine *engine) {
+    return engineGoalsOpen(engine) == 0;
+}
+
+int engineGoalsOpen(struct searchEngine *engine) {
+    if(engine->backend == BACKEND_BITBOARD) {
+        /* Anchors in state are kept current by both backends. */
+        return count_open_goals(engine->board, engine->state->piece_y[0], engine->state->piece_x[0]);
+    }
+    return engine->state->goals_open;
+}
+
+bool engineMove(struct searchEngine *engine, int piece, char direction) {
+    if(engine->backend == BACKEND_BITBOARD) {
+        if(! bitstate_move(&engine->bits, piece, direction)) {
+            return false;
+        }
+        syncAnchor(engine, piece);
+        engine->lastMove.piece = piece;
+        engine->lastDirection = direction;
+        return true;
+    }
+    engine->lastMove = make_move(engine->state, piece, direction);
+    return engine->lastMove.piece != -1;
+}
+
+/* Direction taking a bitboard move back. */
+static char reverseDirection(char direction) {
+    switch(direction) {
+        case 'u': return 'd';
+        case 'd': return 'u';
+        case 'l': return 'r';
+        default: return 'l';
+    }
+}
+
+void engineUndo(struct searchEngine *engine) {
+    int piece = engine->lastMove.piece;
+    if(engine->backend == BACKEND_BITBOARD) {
+        /* The cells just vacated are free, so moving back always succeeds. */
+        bitstate_move(&engine->bits, piece, reverseDirection(engine->lastDirection));
+        syncAnchor(engine, piece);
+        return;
+    }
+    unmake_move(engine->state, &engine->lastMove);
+}
+
+void freeSearchEngine(struct searchEngine *engine) {
+    free(engine);
+}
+
+uint64_t engineHash(struct searchEngine *engine) {
+    return engine->state->hash;
+}
@@ -0,0 +1,64 @@
+/*
+ * Move engine used by the search algorithms. Wraps the selected backend -
+ * the character map (move_piece) or bitboards (bitstate_move) - behind one
+ * interface, so each algorithm is written once for both.
+*/
+#ifndef __ENGINE__
+#define __ENGINE__
+
+#include <stdbool.h>
+#include "gate.h"
+#include "bitboard.h"
+#include "node.h"
+
+#define BACKEND_MAP 0
+#define BACKEND_BITBOARD 1
+
+struct searchEngine {
+    int backend;
+    board_t *board;
+    /* 
+        Scratch state. Its piece_x/piece_y always hold the current position
+        for either backend; its map is only kept up to date by BACKEND_MAP.
+    */
+    gate_t *state;
+    bitstate_t bits;
+    /* Record taking back the last move made, for engineUndo. */
+    move_undo_t lastMove;
+    char lastDirection;
+};
+
+/* Creates an engine working on the given scratch state. */
+struct searchEngine *newSearchEngine(gate_t *state, int backend);
+
+/* Makes the position held in node the current position. */
+void engineLoad(struct searchEngine *engine, struct node *node);
+
+/* Checks if the current position is won, in O(1). */
+bool engineWon(struct searchEngine *engine);
+
+/* 
+    Number of goal cells in the current position not covered by piece 0 
+    (uncovered or under another piece), in O(1).
+*/
+int engineGoalsOpen(struct searchEngine *engine);
+
+/* 
+    Moves piece in direction (one of u, d, l, r). Returns whether the piece 
+    moved.
+*/
+bool engineMove(struct searchEngine *engine, int piece, char direction);
+
+/* 
+    Zobrist key of the current position, updated in O(1) per move. Equal
+    positions always share a key; different positions almost never do.
+*/
+uint64_t engineHash(struct searchEngine *engine);
+
+/* Takes back the last move made by engineMove. */
+void engineUndo(struct searchEngine *engine);
+
+/* Frees the engine, the scratch state remains owned by the caller. */
+void freeSearchEngine(struct searchEngine *engine);
+
+#endif
@@ -0,0 +1,117 @@
+#include "frontier.h"
+#include "node.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define INITIALKEYS 1024
+
+struct frontier *newFrontier(int keyBytes) {
+    struct frontier *frontier = (struct frontier *) malloc(sizeof(struct frontier));
+    assert(frontier);
+    frontier->keyBytes = keyBytes;
+    frontier->count = 0;
+    frontier->head = 0;
+    frontier->keyStart = 0;
+    frontier->keyCapacity = INITIALKEYS;
+    frontier->keys = (unsigned char *) malloc((size_t) INITIALKEYS * keyBytes);
+    assert(frontier->keys);
+    frontier->parents = newArena(sizeof(int));
+    frontier->moves = newArena(sizeof(unsigned char));
+    return frontier;
+}
+
+int frontierPush(struct frontier *frontier, unsigned char *key, int parent, unsigned char move) {
+    int keyBytes = frontier->keyBytes;
+    if(frontier->count - frontier->keyStart == frontier->keyCapacity) {
+        int waiting = frontier->count - frontier->head;
+        if(waiting <= frontier->keyCapacity / 2) {
+            /* At least half the keys were dequeued, slide the rest down. */
+            memmove(frontier->keys, 
+                frontier->keys + (size_t) (frontier->head - frontier->keyStart) * keyBytes,
+                (size_t) waiting * keyBytes);
+            frontier->keyStart = frontier->head;
+        } else {
+            frontier->keyCapacity *= 2;
+            frontier->keys = (unsigned char *) realloc(frontier->keys, 
+                (size_t) frontier->keyCapacity * keyBytes);
+            assert(frontier->keys);
+        }
+    }
+    memcpy(frontier->keys + (size_t) (frontier->count - frontier->keyStart) * keyBytes, key, keyBytes);
+    *(int *) arenaGet(frontier->parents, arenaAlloc(frontier->parents)) = parent;
+    *(unsigned char *) arenaGet(frontier->moves, arenaAlloc(frontier->moves)) = move;
+    return frontier->count++;
+}
+
+int frontierPop(struct frontier *frontier, unsigned char *key) {
+    if(frontier->head == frontier->count) {
+        return -1;
+    }
+    memcpy(key, frontier->keys + (size_t) (frontier->head - frontier->keyStart) * frontier->keyBytes,
+        frontier->keyBytes);
+    return frontier->head++;
+}
+
+int frontierReserve(struct frontier *frontier, int count) {
+    int keyBytes = frontier->keyBytes;
+    if(frontier->count - frontier->keyStart + count > frontier->keyCapacity) {
+        int waiting = frontier->count - frontier->head;
+        memmove(frontier->keys, 
+            frontier->keys + (size_t) (frontier->head - frontier->keyStart) * keyBytes,
+            (size_t) waiting * keyBytes);
+        frontier->keyStart = frontier->head;
+        if(waiting + count > frontier->keyCapacity) {
+            while(waiting + count > frontier->keyCapacity) {
+                frontier->keyCapacity *= 2;
+            }
+            frontier->keys = (unsigned char *) realloc(frontier->keys, 
+                (size_t) frontier->keyCapacity * keyBytes);
+            assert(frontier->keys);
+        }
+    }
+    arenaAllocRange(frontier->parents, count);
+    arenaAllocRange(frontier->moves, count);
+    int idx = frontier->count;
+    frontier->count += count;
+    return idx;
+}
+
+void frontierSet(struct frontier *frontier, int idx, unsigned char *key, int parent, unsigned char move) {
+    memcpy(frontierKey(frontier, idx), key, frontier->keyBytes);
+    *(int *) arenaGet(frontier->parents, idx) = parent;
+    *(unsigned char *) arenaGet(frontier->moves, idx) = move;
+}
+
+char *frontierSolution(struct frontier *frontier, int idx) {
+    int depth = 0;
+    for(int i = idx; *(int *) arenaGet(frontier->parents, i) != NOPARENT; i = *(int *) arenaGet(frontier->parents, i)) {
+        depth++;
+    }
+    char *soln = (char *) malloc(depth * 2 + 1);
+    assert(soln);
+    soln[depth * 2] = '\0';
+    for(int i = idx; *(int *) arenaGet(frontier->parents, i) != NOPARENT; i = *(int *) arenaGet(frontier->parents, i)) {
+        unsigned char move = *(unsigned char *) arenaGet(frontier->moves, i);
+        depth--;
+        soln[depth * 2] = '0' + MOVEPIECE(move);
+        soln[depth * 2 + 1] = MOVEDIR(move);
+    }
+    return soln;
+}
+
+int queryFrontierMemoryUsage(struct frontier *frontier) {
+    return frontier->keyCapacity * frontier->keyBytes
+        + queryArenaMemoryUsage(frontier->parents)
+        + queryArenaMemoryUsage(frontier->moves);
+}
+
+void freeFrontier(struct frontier *frontier) {
+    if(! frontier) {
+        return;
+    }
+    free(frontier->keys);
+    freeArena(frontier->parents);
+    freeArena(frontier->moves);
+    free(frontier);
+}
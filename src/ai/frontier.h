@@ -0,0 +1,67 @@
+/*
+ * BFS queue holding nodes as packed states (the packMap output) of fixed 
+ * width in one flat byte array, rather than as full nodes. Every node keeps
+ * the index of its parent and the move from it, five bytes, so the solution 
+ * can be spelled out; its packed state is only held while it waits in the
+ * queue, and the space of dequeued states is reused.
+*/
+#ifndef __FRONTIER__
+#define __FRONTIER__
+
+#include "arena.h"
+
+struct frontier {
+    int keyBytes;
+    /* Nodes pushed so far, the index of the next one. */
+    int count;
+    /* Nodes popped so far, the index of the next one. */
+    int head;
+    /* Packed states of nodes keyStart onwards, keyCapacity of them. */
+    unsigned char *keys;
+    int keyStart;
+    int keyCapacity;
+    /* Parent index and move of every node. */
+    struct arena *parents;
+    struct arena *moves;
+};
+
+/* Creates an empty queue of packed states of keyBytes bytes. */
+struct frontier *newFrontier(int keyBytes);
+
+/* 
+    Appends a node: its packed state, the index of the node it was generated
+    from (NOPARENT for the root) and the move from there. Returns its index.
+*/
+int frontierPush(struct frontier *frontier, unsigned char *key, int parent, unsigned char move);
+
+/* 
+    Removes the oldest node, copying its packed state into key. Returns its
+    index, or -1 if the queue is empty.
+*/
+int frontierPop(struct frontier *frontier, unsigned char *key);
+
+/*
+    Appends count nodes at once and returns the index of the first. Their
+    packed states, parents and moves are then set with frontierSet, by
+    several threads at once if need be. Dequeued states are dropped first.
+*/
+int frontierReserve(struct frontier *frontier, int count);
+
+/* Sets the packed state, parent and move of reserved node idx. */
+void frontierSet(struct frontier *frontier, int idx, unsigned char *key, int parent, unsigned char move);
+
+/* Packed state of node idx, which must not have been dropped. */
+static inline unsigned char *frontierKey(struct frontier *frontier, int idx) {
+    return frontier->keys + (size_t) (idx - frontier->keyStart) * frontier->keyBytes;
+}
+
+/* Solution string for node idx, as buildSolution. */
+char *frontierSolution(struct frontier *frontier, int idx);
+
+/* Return memory held by the queue. */
+int queryFrontierMemoryUsage(struct frontier *frontier);
+
+/* Free queue */
+void freeFrontier(struct frontier *frontier);
+
+#endif
@@ -0,0 +1,63 @@
+#include "heuristic.h"
+#include <stdlib.h>
+#include <stdbool.h>
+#include <assert.h>
+
+/* Whether piece 0 anchored at (y, x) lies on floor and goals only. */
+static bool fits(board_t const *board, int y, int x) {
+    for(int k = 0; k < board->footprint_size[0]; k++) {
+        int cy = y + board->footprint_dy[0][k];
+        int cx = x + board->footprint_dx[0][k];
+        if(cy < 0 || cy >= board->lines || cx < 0 || cx >= board->columns) {
+            return false;
+        }
+        char tile = board->cells[cy * board->columns + cx];
+        if(tile != ' ' && tile != 'G') {
+            return false;
+        }
+    }
+    return true;
+}
+
+int *newGoalDistances(board_t const *board) {
+    int cellCount = board->lines * board->columns;
+    int *distances = (int *) malloc(sizeof(int) * cellCount);
+    assert(distances);
+    int *queue = (int *) malloc(sizeof(int) * cellCount);
+    assert(queue);
+    int head = 0;
+    int tail = 0;
+    /* Every winning anchor is a source, moves are reversible on walls alone. */
+    for(int cell = 0; cell < cellCount; cell++) {
+        distances[cell] = GOALUNREACHABLE;
+        if(board->goal_cover[cell] == board->num_goals
+            && fits(board, cell / board->columns, cell % board->columns)) {
+            distances[cell] = 0;
+            queue[tail++] = cell;
+        }
+    }
+    int const dy[4] = {-1, 1, 0, 0};
+    int const dx[4] = {0, 0, -1, 1};
+    while(head < tail) {
+        int cell = queue[head++];
+        int y = cell / board->columns;
+        int x = cell % board->columns;
+        for(int d = 0; d < 4; d++) {
+            int ny = y + dy[d];
+            int nx = x + dx[d];
+            int next = ny * board->columns + nx;
+            if(ny < 0 || ny >= board->lines || nx < 0 || nx >= board->columns 
+                || distances[next] != GOALUNREACHABLE || ! fits(board, ny, nx)) {
+                continue;
+            }
+            distances[next] = distances[cell] + 1;
+            queue[tail++] = next;
+        }
+    }
+    free(queue);
+    return distances;
+}
+
+void freeGoalDistances(int *distances) {
+    free(distances);
+}
@@ -0,0 +1,24 @@
+/*
+ * Admissible distance-to-goal estimates for informed search, precomputed
+ * once per board.
+*/
+#ifndef __HEURISTIC__
+#define __HEURISTIC__
+
+#include "gate.h"
+
+/* Distance of an anchor from which piece 0 can never cover every goal. */
+#define GOALUNREACHABLE (-1)
+
+/*
+	Returns, for each cell as a piece 0 anchor, the fewest moves taking piece 0
+	to a position covering every goal on the board with only the walls in 
+	place (GOALUNREACHABLE if there is none, or piece 0 does not fit there). 
+	Other pieces can only add moves, so this never overestimates.
+*/
+int *newGoalDistances(board_t const *board);
+
+/* Free distances */
+void freeGoalDistances(int *distances);
+
+#endif
@@ -0,0 +1,89 @@
+#include "keyset.h"
+#include <stdlib.h>
+#include <assert.h>
+
+#define INITIALSLOTS 1024
+/* Slot value marking an empty slot, the key 0 itself is held in hasZero. */
+#define EMPTYKEY 0
+
+struct keySet {
+    /* Power of two so a key maps to a slot with a mask. */
+    uint64_t slotCount;
+    uint64_t used;
+    bool hasZero;
+    uint64_t *slots;
+};
+
+struct keySet *newKeySet(void) {
+    struct keySet *set = (struct keySet *) malloc(sizeof(struct keySet));
+    assert(set);
+    set->slotCount = INITIALSLOTS;
+    set->used = 0;
+    set->hasZero = false;
+    set->slots = (uint64_t *) calloc(INITIALSLOTS, sizeof(uint64_t));
+    assert(set->slots);
+    return set;
+}
+
+/* Slot holding key, or the empty slot where it would go. Linear probing. */
+static uint64_t findSlot(uint64_t *slots, uint64_t slotCount, uint64_t key) {
+    /* Zobrist keys are already uniform, fold the high bits in anyway. */
+    uint64_t mask = slotCount - 1;
+    uint64_t idx = (key ^ (key >> 32)) & mask;
+    while(slots[idx] != EMPTYKEY && slots[idx] != key) {
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+bool keySetContains(struct keySet *set, uint64_t key) {
+    if(key == EMPTYKEY) {
+        return set->hasZero;
+    }
+    return set->slots[findSlot(set->slots, set->slotCount, key)] == key;
+}
+
+/* Doubles the table, keeping the load factor at or below one half. */
+static void growKeySet(struct keySet *set) {
+    uint64_t newCount = set->slotCount * 2;
+    uint64_t *newSlots = (uint64_t *) calloc(newCount, sizeof(uint64_t));
+    assert(newSlots);
+    for(uint64_t i = 0; i < set->slotCount; i++) {
+        if(set->slots[i] != EMPTYKEY) {
+            newSlots[findSlot(newSlots, newCount, set->slots[i])] = set->slots[i];
+        }
+    }
+    free(set->slots);
+    set->slots = newSlots;
+    set->slotCount = newCount;
+}
+
+bool keySetInsert(struct keySet *set, uint64_t key) {
+    if(key == EMPTYKEY) {
+        bool inserted = ! set->hasZero;
+        set->hasZero = true;
+        return inserted;
+    }
+    uint64_t idx = findSlot(set->slots, set->slotCount, key);
+    if(set->slots[idx] == key) {
+        return false;
+    }
+    set->slots[idx] = key;
+    set->used++;
+    if(set->used * 2 > set->slotCount) {
+        growKeySet(set);
+    }
+    return true;
+}
+
+int queryKeySetMemoryUsage(struct keySet *set) {
+    return set->slotCount * sizeof(uint64_t);
+}
+
+void freeKeySet(struct keySet *set) {
+    if(! set) {
+        return;
+    }
+    free(set->slots);
+    free(set);
+}
@@ -0,0 +1,28 @@
+/*
+ * Open-addressing set of 64-bit state keys (Zobrist keys). Used as a fast 
+ * visited-state filter in front of, or instead of, the radix tree.
+*/
+#ifndef __KEYSET__
+#define __KEYSET__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct keySet;
+
+/* Creates an empty set. */
+struct keySet *newKeySet(void);
+
+/* Checks if key is in the set. */
+bool keySetContains(struct keySet *set, uint64_t key);
+
+/* Inserts key, returning true if it was not already present. */
+bool keySetInsert(struct keySet *set, uint64_t key);
+
+/* Return memory used by the set's table. */
+int queryKeySetMemoryUsage(struct keySet *set);
+
+/* Free set */
+void freeKeySet(struct keySet *set);
+
+#endif
@@ -0,0 +1,37 @@
+#include "node.h"
+#include <stdlib.h>
+#include <assert.h>
+
+void stateToNode(gate_t *state, struct node *node) {
+    for(int i = 0; i < MAX_PIECES; i++) {
+        node->piece_x[i] = state->piece_x[i];
+        node->piece_y[i] = state->piece_y[i];
+    }
+    node->parent = NOPARENT;
+    node->move = 0;
+}
+
+void nodeToState(board_t *board, struct node *node, gate_t *state) {
+    for(int i = 0; i < MAX_PIECES; i++) {
+        state->piece_x[i] = node->piece_x[i];
+        state->piece_y[i] = node->piece_y[i];
+    }
+    render_board(board, state);
+}
+
+char *buildSolution(struct arena *nodes, int idx) {
+    int depth = 0;
+    struct node *node;
+    for(node = arenaGet(nodes, idx); node->parent != NOPARENT; node = arenaGet(nodes, node->parent)) {
+        depth++;
+    }
+    char *soln = (char *) malloc(depth * 2 + 1);
+    assert(soln);
+    soln[depth * 2] = '\0';
+    for(node = arenaGet(nodes, idx); node->parent != NOPARENT; node = arenaGet(nodes, node->parent)) {
+        depth--;
+        soln[depth * 2] = '0' + MOVEPIECE(node->move);
+        soln[depth * 2 + 1] = MOVEDIR(node->move);
+    }
+    return soln;
+}
@@ -0,0 +1,45 @@
+/*
+ * Lightweight search nodes. A node only records what changes between states
+ * (the anchor of each piece) plus how it was reached; walls and goals live
+ * once in the shared board_t.
+*/
+#ifndef __NODE__
+#define __NODE__
+
+#include "gate.h"
+#include "arena.h"
+
+/* Parent index of the root node. */
+#define NOPARENT (-1)
+
+/* 
+    A move packed in one byte: piece index in the high bits, direction index
+    (position in MOVEDIRECTIONS) in the low two bits.
+*/
+#define MOVEDIRECTIONS "udlr"
+#define ENCODEMOVE(piece, dirIdx) ((unsigned char) (((piece) << 2) | (dirIdx)))
+#define MOVEPIECE(move) ((move) >> 2)
+#define MOVEDIR(move) (MOVEDIRECTIONS[(move) & 3])
+
+struct node {
+    signed char piece_x[MAX_PIECES];
+    signed char piece_y[MAX_PIECES];
+    /* Move applied to the parent to reach this node. */
+    unsigned char move;
+    /* Index of the node this one was generated from, NOPARENT for the root. */
+    int parent;
+};
+
+/* Copy the piece locations of the given state into the node. */
+void stateToNode(gate_t *state, struct node *node);
+
+/* Overwrite the map of the given state with the position held in node. */
+void nodeToState(board_t *board, struct node *node, gate_t *state);
+
+/* 
+    Build the solution string for node idx of the arena by walking back to 
+    the root, the only place the path is ever spelled out.
+*/
+char *buildSolution(struct arena *nodes, int idx);
+
+#endif
@@ -0,0 +1,191 @@
+#include "novelty.h"
+#include "radix.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+
+struct noveltyTable {
+    int numPieces;
+    int size;
+    /* Bits per field and per atom in a packed state. */
+    int pBits;
+    int hBits;
+    int wBits;
+    int atomSize;
+    /* Dense index of each packed atom value, piece * height * width + y * width + x. */
+    int *atomIndex;
+    /* Dense indices of the atoms of the state being checked. */
+    int *atoms;
+    /* Size 1: one bit per atom. Size 2: one bit per unordered pair of atoms. */
+    uint64_t bitCount;
+    uint64_t *bits;
+    /* Size 3 and up. */
+    struct radixTree *rt;
+};
+
+/* Reads count bits starting at bitIndex, in the order bitOn writes them. */
+static int readBits(unsigned char *s, int bitIndex, int count) {
+    int value = 0;
+    for(int i = 0; i < count; i++) {
+        value = (value << 1) | getBit(s, bitIndex + i);
+    }
+    return value;
+}
+
+/* Value of a field as packMap writes it, least significant bit first. */
+static int packField(int value, int bits) {
+    int packed = 0;
+    for(int j = 0; j < bits; j++) {
+        packed = (packed << 1) | ((value >> j) & 1);
+    }
+    return packed;
+}
+
+struct noveltyTable *newNoveltyTable(int numPieces, int height, int width, int size) {
+    assert(size >= 1 && size <= numPieces);
+    struct noveltyTable *table = (struct noveltyTable *) malloc(sizeof(struct noveltyTable));
+    assert(table);
+    table->numPieces = numPieces;
+    table->size = size;
+    table->pBits = calcBits(numPieces);
+    table->hBits = calcBits(height);
+    table->wBits = calcBits(width);
+    table->atomSize = table->pBits + table->hBits + table->wBits;
+    table->atomIndex = NULL;
+    table->atoms = NULL;
+    table->bitCount = 0;
+    table->bits = NULL;
+    table->rt = NULL;
+    if(size > 2) {
+        table->rt = getNewRadixTree(numPieces, height, width);
+        return table;
+    }
+
+    /* Map every packed atom value to its dense index. */
+    table->atomIndex = (int *) malloc(sizeof(int) * (1 << table->atomSize));
+    assert(table->atomIndex);
+    for(int p = 0; p < numPieces; p++) {
+        for(int y = 0; y < height; y++) {
+            for(int x = 0; x < width; x++) {
+                int packed = (packField(p, table->pBits) << (table->hBits + table->wBits))
+                    | (packField(y, table->hBits) << table->wBits) 
+                    | packField(x, table->wBits);
+                table->atomIndex[packed] = (p * height + y) * width + x;
+            }
+        }
+    }
+    table->atoms = (int *) malloc(sizeof(int) * numPieces);
+    assert(table->atoms);
+
+    uint64_t atomCount = (uint64_t) numPieces * height * width;
+    if(size == 1) {
+        table->bitCount = atomCount;
+    } else {
+        table->bitCount = atomCount * (atomCount - 1) / 2;
+    }
+    table->bits = (uint64_t *) calloc((table->bitCount + 63) / 64, sizeof(uint64_t));
+    assert(table->bits);
+    return table;
+}
+
+/* Fills atoms with the dense index of each atom of the packed state. */
+static void readAtoms(struct noveltyTable *table, unsigned char *bitPacked, int *atoms) {
+    for(int i = 0; i < table->numPieces; i++) {
+        atoms[i] = table->atomIndex[readBits(bitPacked, table->atomSize * i, table->atomSize)];
+    }
+}
+
+/* Bit of the atom combination starting at atom i (and atom j, for pairs). */
+static inline uint64_t comboBit(struct noveltyTable *table, int const *atoms, int i, int j) {
+    if(table->size == 1) {
+        return atoms[i];
+    }
+    /* Atoms of different pieces are never equal, order the pair. */
+    uint64_t lo = atoms[i];
+    uint64_t hi = atoms[j];
+    if(lo > hi) {
+        uint64_t t = lo;
+        lo = hi;
+        hi = t;
+    }
+    return hi * (hi - 1) / 2 + lo;
+}
+
+int checkPresentNovelty(struct noveltyTable *table, unsigned char *bitPacked) {
+    if(table->rt) {
+        return checkPresentnCr(table->rt, bitPacked, table->size);
+    }
+    readAtoms(table, bitPacked, table->atoms);
+    int lastJ = (table->size == 1) ? 0 : table->numPieces - 1;
+    for(int i = 0; i < table->numPieces; i++) {
+        for(int j = (table->size == 1) ? 0 : i + 1; j <= lastJ; j++) {
+            uint64_t bit = comboBit(table, table->atoms, i, j);
+            if(! (table->bits[bit / 64] & ((uint64_t) 1 << (bit % 64)))) {
+                return NOTPRESENT;
+            }
+        }
+    }
+    return PRESENT;
+}
+
+/* Inserts the combinations of atoms already read by readAtoms into a bitset table. */
+static int insertAtoms(struct noveltyTable *table, int const *atoms) {
+    int inserted = 0;
+    int lastJ = (table->size == 1) ? 0 : table->numPieces - 1;
+    for(int i = 0; i < table->numPieces; i++) {
+        for(int j = (table->size == 1) ? 0 : i + 1; j <= lastJ; j++) {
+            uint64_t bit = comboBit(table, atoms, i, j);
+            uint64_t mask = (uint64_t) 1 << (bit % 64);
+            if(! (table->bits[bit / 64] & mask)) {
+                table->bits[bit / 64] |= mask;
+                inserted++;
+            }
+        }
+    }
+    return inserted;
+}
+
+int insertNovelty(struct noveltyTable *table, unsigned char *bitPacked) {
+    if(table->rt) {
+        return insertRadixTreenCr(table->rt, bitPacked, table->size);
+    }
+    readAtoms(table, bitPacked, table->atoms);
+    return insertAtoms(table, table->atoms);
+}
+
+int evaluateNovelty(struct noveltyTable **tables, int w, unsigned char *bitPacked) {
+    int novelty = 0;
+    /* Atoms are unpacked once and shared by the bitset tables. */
+    int *atoms = tables[1]->atoms;
+    readAtoms(tables[1], bitPacked, atoms);
+    for(int k = 1; k <= w; k++) {
+        int inserted;
+        if(tables[k]->rt) {
+            inserted = insertRadixTreenCr(tables[k]->rt, bitPacked, k);
+        } else {
+            inserted = insertAtoms(tables[k], atoms);
+        }
+        if(inserted > 0 && novelty == 0) {
+            novelty = k;
+        }
+    }
+    return novelty;
+}
+
+int queryNoveltyMemoryUsage(struct noveltyTable *table) {
+    if(table->rt) {
+        return queryRadixMemoryUsage(table->rt);
+    }
+    return (table->bitCount + 63) / 64 * sizeof(uint64_t);
+}
+
+void freeNoveltyTable(struct noveltyTable *table) {
+    if(! table) {
+        return;
+    }
+    freeRadixTree(table->rt);
+    free(table->atomIndex);
+    free(table->atoms);
+    free(table->bits);
+    free(table);
+}
@@ -0,0 +1,46 @@
+/*
+ * Novelty tables for iterated width: the set of atom combinations of one size
+ * k seen so far, where an atom is one piece at one location. For k = 1 and 
+ * k = 2 the atom space is small enough to index directly, so those sizes use 
+ * a flat bitset and a triangular pair bitmap; larger sizes fall back to a 
+ * radix tree of packed combinations.
+*/
+#ifndef __NOVELTY__
+#define __NOVELTY__
+
+struct noveltyTable;
+
+/*
+	Creates an empty table of size-combinations, numPieces is the number of 
+	pieces that are on the board, height and width are of the board.
+*/
+struct noveltyTable *newNoveltyTable(int numPieces, int height, int width, int size);
+
+/* 
+	Checks if all size-combinations of the atoms of the state packed by 
+	packMap are in the table, as checkPresentnCr. 
+*/
+int checkPresentNovelty(struct noveltyTable *table, unsigned char *bitPacked);
+
+/* 
+	Inserts all size-combinations of the atoms of the packed state, returning 
+	how many were not already present, as insertRadixTreenCr.
+*/
+int insertNovelty(struct noveltyTable *table, unsigned char *bitPacked);
+
+/*
+	Novelty of the packed state against tables[1] to tables[w] (tables of 
+	sizes 1 to w, all for the same board): the smallest k for which the state
+	has a combination not seen before, or 0 if it has none (not novel). Every 
+	new combination of every size up to w is inserted in the same pass, the 
+	atoms being unpacked once.
+*/
+int evaluateNovelty(struct noveltyTable **tables, int w, unsigned char *bitPacked);
+
+/* Return memory used by the table. */
+int queryNoveltyMemoryUsage(struct noveltyTable *table);
+
+/* Free table */
+void freeNoveltyTable(struct noveltyTable *table);
+
+#endif
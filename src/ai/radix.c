@@ -1,11 +1,45 @@
 #include "radix.h"
 #include "utils.h"
+#include "gate.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <assert.h>
+#include <limits.h>
 #include <string.h>
-
-#define INITIALCAPACITY 1024
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* Nodes per node page, a power of two so indices split with shifts. */
+#define NODEPAGEBITS 12
+#define NODEPAGESIZE (1 << NODEPAGEBITS)
+/* Prefix bits per prefix page, a prefix never straddles two pages. */
+#define PREFIXPAGEBITS 20
+#define PREFIXPAGESIZE (1 << PREFIXPAGEBITS)
+/* Bytes after the end of each prefix page, so whole words can be read. */
+#define PREFIXPAGEPAD 8
+/* Initial room in the page tables, doubled as needed. */
+#define INITIALPAGES 16
+
+/* Width of the prefix length field of a node record. */
+#define NUMBITSBITS 7
+/* Child pair of a leaf. */
+#define NOCHILDPAIR UINT32_MAX
+
+/*
+    One node, all fields of which are read together when walking the tree, 
+    packed into 12 bytes. Children are always created together, so a node holds 
+    the index of its pair: branchA is node 1 + 2 * childPair, branchB the node 
+    after it. The fields are wide enough for any tree whose node indices fit 
+    an int.
+*/
+struct radixNode {
+    /* First bit of the prefix in the prefix pages. */
+    uint64_t bitStart : 64 - NUMBITSBITS;
+    /* Prefix length, a full key is at most MAX_PIECES * 13 bits. */
+    uint64_t numBits : NUMBITSBITS;
+    uint32_t childPair;
+} __attribute__((packed, aligned(4)));
 
 /* Packed radix tree. */
 struct radixTree {
@@ -14,30 +48,53 @@ struct radixTree {
     int height;
     int width;
 
-    // Structure of tree packed as struct of (bit) arrays.
+    // Nodes live in fixed size pages which never move, growth only adds a page.
     int nodeCount;
-    int nodeCapacity;
- 
-    int *prefixBitStartBytes;
-    
-    int *prefixBitsBytes;
-    // Bits are stored in one contiguous bit array referred to by all nodes.
-    int prefixBitsAllocated;
-    int prefixBitsUsed;
-    unsigned char *prefixBytes;
-    int *branchABytes;
-    int *branchBBytes;
+    int nodePageCount;
+    int nodePageCapacity;
+    struct radixNode **nodePages;
+
+    // Bits are stored in pages referred to by all nodes, bit b of the pool 
+    // being bit b % PREFIXPAGESIZE of page b / PREFIXPAGESIZE.
+    uint64_t prefixBitsUsed;
+    int prefixPageCount;
+    int prefixPageCapacity;
+    unsigned char **prefixPages;
+
+    // Reused by the nCr functions: the atoms of the state being split up, 
+    // the key of one combination of them and, for each size k, every 
+    // k-combination of atom indices in lexicographic order, built on first use.
+    uint64_t *atoms;
+    unsigned char *partialBitPack;
+    unsigned char **combos;
+    int *comboCount;
+
+    // Order of the keys of a batch given to insertRadixTreeBatch, and room 
+    // for sorting it.
+    int batchCapacity;
+    int *batchOrder;
+    int *batchScratch;
+
+    // File mapping the pages point into when loaded by loadRadixTree, NULL 
+    // once the pages are the tree's own.
+    void *mapping;
+    size_t mappingLength;
 };
 
-// Helper structure.
-struct radixTreeNode;
-
-struct radixTreeNode {
-    int nodeIdx;
-    int bitStart;
-    int numBits;
-    int branchA;
-    int branchB;
+/* Header of a snapshot file, followed by the node records and prefix pages. */
+#define SNAPSHOTMAGIC "RADIXT1"
+struct radixSnapshotHeader {
+    char magic[8];
+    /* Layout checks, a snapshot is only read by a build with the same layout. */
+    int32_t nodeRecordSize;
+    int32_t nodePageBits;
+    int32_t prefixPageBits;
+    int32_t numPieces;
+    int32_t height;
+    int32_t width;
+    int32_t nodeCount;
+    int32_t prefixPageCount;
+    uint64_t prefixBitsUsed;
 };
 
 /* Number of bits in a single character. */
@@ -70,12 +127,13 @@ int getBit(unsigned char *s, unsigned int bitIndex){
 int queryRadixMemoryUsage(struct radixTree *tree) {
     int memoryUsage = 0;
     /* 
-        Data for each node:
-        prefixBitStartByte, prefixBits, branchA, branchB
+        Data for each node: one packed record holding prefix start, prefix 
+        length and child pair.
      */
-    memoryUsage += tree->nodeCount * (sizeof(int) * (1 + 1 + 1 + 1));
+    memoryUsage += tree->nodeCount * sizeof(struct radixNode);
     /*
         Data used in bits - a bit spilling over one byte takes one more byte.
+        The unused end of a prefix page is counted as used.
     */
     memoryUsage += (tree->prefixBitsUsed + (BITS_PER_BYTE - 1)) / BITS_PER_BYTE;
 
@@ -87,6 +145,89 @@ int queryRadixMemoryUsage(struct radixTree *tree) {
     return memoryUsage;
 }
 
+/* Bits compared per step when walking the tree. */
+#define WORD_BITS 64
+
+/*
+    Reads count (1 to 64) bits starting at bitIndex from s, in the same order
+    as getBit, returned left-aligned: bit bitIndex lands in the highest order
+    bit of the result and unread low order bits are zero. Only the bytes
+    holding the requested bits are touched.
+*/
+static inline uint64_t getBits(unsigned char *s, unsigned int bitIndex, int count) {
+    unsigned char *p = s + bitIndex / BITS_PER_BYTE;
+    int shift = bitIndex % BITS_PER_BYTE;
+    int byteCount = (shift + count + (BITS_PER_BYTE - 1)) / BITS_PER_BYTE;
+    uint64_t word = 0;
+    for(int i = 0; i < byteCount && i < 8; i++) {
+        word |= (uint64_t) p[i] << (56 - BITS_PER_BYTE * i);
+    }
+    word <<= shift;
+    if(byteCount > 8) {
+        /* Unaligned 64 bit read, the last bits come from a ninth byte. */
+        word |= p[8] >> (BITS_PER_BYTE - shift);
+    }
+    if(count < WORD_BITS) {
+        word &= ~(uint64_t) 0 << (WORD_BITS - count);
+    }
+    return word;
+}
+
+/* Returns node idx. */
+static inline struct radixNode *getNode(struct radixTree *tree, int idx) {
+    return &tree->nodePages[idx >> NODEPAGEBITS][idx & (NODEPAGESIZE - 1)];
+}
+
+/* Reads count bits of the prefix pool starting at pool bit bitStart. */
+static inline uint64_t getPrefixBits(struct radixTree *tree, uint64_t bitStart, int count) {
+    return getBits(tree->prefixPages[bitStart >> PREFIXPAGEBITS], 
+        bitStart & (PREFIXPAGESIZE - 1), count);
+}
+
+/*
+    Walks the tree along the first bitCount bits of bitPacked, comparing up to
+    a word of prefix bits at a time. Returns the index of the first bit which
+    differs from the tree, or bitCount if every bit matched. The node the walk
+    stopped in and the number of its prefix bits matched are returned through
+    nodeIdx and progress. The tree must not be empty.
+*/
+static int findMismatch(struct radixTree *tree, unsigned char *bitPacked, int bitCount, 
+    int *nodeIdx, int *progress) {
+    int idx = 0;
+    struct radixNode *node = getNode(tree, 0);
+    int matched = 0;
+    int i = 0;
+    while(i < bitCount) {
+        if(matched == (int) node->numBits) {
+            /* Branch, the child's prefix starts with the branching bit. */
+            idx = 1 + 2 * node->childPair + getBit(bitPacked, i);
+            node = getNode(tree, idx);
+            matched = 0;
+        }
+        int count = node->numBits - matched;
+        if(count > bitCount - i) {
+            count = bitCount - i;
+        }
+        if(count > WORD_BITS) {
+            count = WORD_BITS;
+        }
+        uint64_t diff = getPrefixBits(tree, node->bitStart + matched, count) 
+            ^ getBits(bitPacked, i, count);
+        if(diff != 0) {
+            /* Mismatch, the highest set bit of diff is the first differing bit. */
+            int same = __builtin_clzll(diff);
+            *nodeIdx = idx;
+            *progress = matched + same;
+            return i + same;
+        }
+        i += count;
+        matched += count;
+    }
+    *nodeIdx = idx;
+    *progress = matched;
+    return bitCount;
+}
+
 struct radixTree *getNewRadixTree(int numPieces, int height, int width) {
     struct radixTree *rt = (struct radixTree *) malloc(sizeof(struct radixTree));
     assert(rt);
@@ -96,16 +237,32 @@ struct radixTree *getNewRadixTree(int numPieces, int height, int width) {
     rt->width = width;
     
     rt->nodeCount = 0;
-    rt->nodeCapacity = 0;
-
-    rt->prefixBitStartBytes = NULL;
-    rt->prefixBitsBytes = NULL;
-    rt->prefixBytes = NULL;
-    rt->branchABytes = NULL;
-    rt->branchBBytes = NULL;
+    rt->nodePageCount = 0;
+    rt->nodePageCapacity = 0;
+    rt->nodePages = NULL;
 
-    rt->prefixBitsAllocated = 0;
     rt->prefixBitsUsed = 0;
+    rt->prefixPageCount = 0;
+    rt->prefixPageCapacity = 0;
+    rt->prefixPages = NULL;
+
+    int atomSize = calcBits(numPieces) + calcBits(height) + calcBits(width);
+    rt->atoms = (uint64_t *) malloc(sizeof(uint64_t) * (numPieces + 1));
+    assert(rt->atoms);
+    rt->partialBitPack = (unsigned char *) calloc((atomSize * numPieces + (BITS_PER_BYTE - 1)) / BITS_PER_BYTE + 1, 
+        sizeof(unsigned char));
+    assert(rt->partialBitPack);
+    rt->combos = (unsigned char **) calloc(numPieces + 1, sizeof(unsigned char *));
+    assert(rt->combos);
+    rt->comboCount = (int *) calloc(numPieces + 1, sizeof(int));
+    assert(rt->comboCount);
+
+    rt->batchCapacity = 0;
+    rt->batchOrder = NULL;
+    rt->batchScratch = NULL;
+
+    rt->mapping = NULL;
+    rt->mappingLength = 0;
 
     return rt;
 }
@@ -120,42 +277,30 @@ int calcBits(int x) {
     return bitsNeeded;
 }
 
-struct radixTreeNode getTreeNode(struct radixTree *tree, int idx);
-
-struct radixTreeNode getTreeNode(struct radixTree *tree, int idx){
-    struct radixTreeNode rt;
-    
-    rt.nodeIdx = idx;
-    rt.bitStart = tree->prefixBitStartBytes[idx];
-    rt.numBits = tree->prefixBitsBytes[idx];
-    rt.branchA = tree->branchABytes[idx];
-    rt.branchB = tree->branchBBytes[idx];
-
-    return rt;
+/* Adds a page to a page table, growing the table (of pointers only) if full. */
+static void *addPage(void ***pages, int *pageCount, int *pageCapacity, size_t pageBytes) {
+    if(*pageCount == *pageCapacity) {
+        *pageCapacity = *pageCapacity ? *pageCapacity * 2 : INITIALPAGES;
+        *pages = (void **) realloc(*pages, *pageCapacity * sizeof(void *));
+        assert(*pages);
+    }
+    void *page = calloc(1, pageBytes);
+    assert(page);
+    (*pages)[(*pageCount)++] = page;
+    return page;
 }
 
-void storeNode(struct radixTree *tree, struct radixTreeNode *node);
-
-void storeNode(struct radixTree *tree, struct radixTreeNode *node){
-    if(node->nodeIdx >= tree->nodeCount) {
-        while(node->nodeIdx + 1 > tree->nodeCapacity){
-            /* Resize needed. */
-            tree->nodeCapacity *= 2;
-            tree->prefixBitStartBytes = (int *) realloc(tree->prefixBitStartBytes, tree->nodeCapacity * sizeof(int));
-            assert(tree->prefixBitStartBytes);
-            tree->prefixBitsBytes = (int *) realloc(tree->prefixBitsBytes, tree->nodeCapacity * sizeof(int));
-            assert(tree->prefixBitsBytes);
-            tree->branchABytes = (int *) realloc(tree->branchABytes, tree->nodeCapacity * sizeof(int));
-            assert(tree->branchABytes);
-            tree->branchBBytes = (int *) realloc(tree->branchBBytes, tree->nodeCapacity * sizeof(int));
-            assert(tree->branchBBytes);
-        }
-        tree->nodeCount = node->nodeIdx + 1;
+/* Allocates count consecutive nodes, returning the index of the first. */
+static int newNodes(struct radixTree *tree, int count) {
+    /* Node indices are ints, about 25 GB of nodes. */
+    assert(tree->nodeCount <= INT_MAX - count);
+    int idx = tree->nodeCount;
+    tree->nodeCount += count;
+    while(tree->nodeCount > tree->nodePageCount * NODEPAGESIZE) {
+        addPage((void ***) &tree->nodePages, &tree->nodePageCount, 
+            &tree->nodePageCapacity, NODEPAGESIZE * sizeof(struct radixNode));
     }
-    tree->prefixBitStartBytes[node->nodeIdx] = node->bitStart;
-    tree->prefixBitsBytes[node->nodeIdx] = node->numBits;
-    tree->branchABytes[node->nodeIdx] = node->branchA;
-    tree->branchBBytes[node->nodeIdx] = node->branchB;
+    return idx;
 }
 
 /* Checks if the state is present in the radix tree. */
@@ -172,36 +317,21 @@ int checkPresent(struct radixTree *tree, unsigned char *bitPacked, int atomCount
         return NOTPRESENT;
     }
 
-    /* Get root. */
-    struct radixTreeNode node = getTreeNode(tree, 0);
-
     /* Search */
-    int progress = 0;
-    for(int i = 0; i < bitCount; i++) {
-        if(progress == node.numBits){
-            /* Branch. */
-            if(getBit(bitPacked, i) == 0) {
-                node = getTreeNode(tree, node.branchA);
-                progress = 0;
-            } else {
-                node = getTreeNode(tree, node.branchB);
-                progress = 0;
-            }
-        }
-        if(getBit(tree->prefixBytes, node.bitStart + progress) != getBit(bitPacked, i)){
-            /* Mismatch, not in tree. */
-            return NOTPRESENT;
-        }
-        progress++;
+    int nodeIdx;
+    int progress;
+    if(findMismatch(tree, bitPacked, bitCount, &nodeIdx, &progress) < bitCount) {
+        /* Mismatch, not in tree. */
+        return NOTPRESENT;
     }
     /* Got through whole bitPacked representation. Should be true since we assume bitPacked items are always inserted. */
-    assert(progress == node.numBits);
+    assert(progress == (int) getNode(tree, nodeIdx)->numBits);
     return PRESENT;
 }
 
 /* Write bitCount bits, starting from startBit from the bitPacked value into 
-    the prefixBytes of the tree */
-void writeNewBits(struct radixTree *tree, unsigned char *bitPacked, int startBit, int bitCount);
+    the prefix pages of the tree, returning the pool bit they start at. */
+uint64_t writeNewBits(struct radixTree *tree, unsigned char *bitPacked, int startBit, int bitCount);
 
 // BitOn and BitOff written by Danielle Jayanthy for COMP20007 Semester 1 2025 Assignment 2
 // Modified to work consistently with the bit ordering in the getBit function.
@@ -216,25 +346,38 @@ void bitOff( unsigned char A[], unsigned int bitIndex ) {
     A[bitIndex/SIZE] &= ~(1 << (SIZE - (bitIndex%SIZE) - 1));
 }
 
-void writeNewBits(struct radixTree *tree, unsigned char *bitPacked, int startBit, int bitCount){
-    /* Check space for bits. */
-    while(tree->prefixBitsUsed + bitCount > tree->prefixBitsAllocated) {
-        tree->prefixBitsAllocated *= 2;
-        tree->prefixBytes = (unsigned char *) realloc(tree->prefixBytes, tree->prefixBitsAllocated/BITS_PER_BYTE * sizeof(unsigned char));
-        assert(tree->prefixBytes);
+uint64_t writeNewBits(struct radixTree *tree, unsigned char *bitPacked, int startBit, int bitCount){
+    /* Check space for bits, starting a new page rather than straddling two. */
+    uint64_t pageEnd = (uint64_t) tree->prefixPageCount * PREFIXPAGESIZE;
+    if(tree->prefixBitsUsed + bitCount > pageEnd) {
+        /* The rest of the last page, if any, is left unused. */
+        tree->prefixBitsUsed = pageEnd;
+        addPage((void ***) &tree->prefixPages, &tree->prefixPageCount, 
+            &tree->prefixPageCapacity, PREFIXPAGESIZE / BITS_PER_BYTE + PREFIXPAGEPAD);
     }
+    uint64_t bitStart = tree->prefixBitsUsed;
+    unsigned char *page = tree->prefixPages[bitStart >> PREFIXPAGEBITS];
+    unsigned int pageBit = bitStart & (PREFIXPAGESIZE - 1);
     for(int i = 0; i < bitCount; i++) {
         if(getBit(bitPacked, startBit + i) == 0){
-            bitOff(tree->prefixBytes, tree->prefixBitsUsed + i);
+            bitOff(page, pageBit + i);
         } else {
-            bitOn(tree->prefixBytes, tree->prefixBitsUsed + i);
+            bitOn(page, pageBit + i);
         }
     }
     tree->prefixBitsUsed += bitCount;
+    return bitStart;
 }
 
 /* Inserts the state into the radix tree. */
 void insertRadixTree(struct radixTree *tree, unsigned char *bitPacked, int atomCount) {
+    insertIfAbsent(tree, bitPacked, atomCount);
+}
+
+static void thawRadixTree(struct radixTree *tree);
+
+/* Inserts the state unless present, walking the tree once. */
+int insertIfAbsent(struct radixTree *tree, unsigned char *bitPacked, int atomCount) {
     int pBits = calcBits(tree->numPieces);
     int hBits = calcBits(tree->height);
     int wBits = calcBits(tree->width);
@@ -242,111 +385,132 @@ void insertRadixTree(struct radixTree *tree, unsigned char *bitPacked, int atomC
 
     /* Full check, so bits contain location of all pieces. */
     int bitCount = atomSize * atomCount;
+    assert(bitCount < (1 << NUMBITSBITS));
 
-    /* Simple check, do not insert if already present. */
-    if(checkPresent(tree, bitPacked, atomCount)){
-        return;
+    /* A loaded tree is read-only, take a private copy before changing it. */
+    if(tree->mapping) {
+        thawRadixTree(tree);
     }
 
     /* Empty tree. */
-    if(tree->nodeCapacity == 0) {
-        tree->nodeCapacity = INITIALCAPACITY;
-        
-        tree->prefixBitStartBytes = (int *) malloc(sizeof(int) * INITIALCAPACITY);
-        assert(tree->prefixBitStartBytes);
-        tree->prefixBitsBytes = (int *) malloc(sizeof(int) * INITIALCAPACITY);
-        assert(tree->prefixBitsBytes);
-        tree->branchABytes = (int *) malloc(sizeof(int) * INITIALCAPACITY);
-        assert(tree->branchABytes);
-        tree->branchBBytes = (int *) malloc(sizeof(int) * INITIALCAPACITY);
-        assert(tree->branchBBytes);
-
-        (tree->prefixBitStartBytes)[0] = 0;
-        (tree->branchABytes)[0] = NOCHILD;
-        (tree->branchBBytes)[0] = NOCHILD;
-        (tree->prefixBitsBytes)[0] = bitCount;
-        
-        // Start with INITIALCAPACITY full length prefixes of bitCount length.
-        tree->prefixBitsAllocated = ((((bitCount * INITIALCAPACITY + (BITS_PER_BYTE - 1)))/BITS_PER_BYTE)) * sizeof(unsigned char) * BITS_PER_BYTE;
-        tree->prefixBytes = (unsigned char *) calloc((((bitCount * INITIALCAPACITY + (BITS_PER_BYTE - 1)))/BITS_PER_BYTE), sizeof(unsigned char));
-        assert(tree->prefixBytes);
-
-        writeNewBits(tree, bitPacked, 0, bitCount);
-
-        (tree->nodeCount)++;
-        return;
+    if(tree->nodeCount == 0) {
+        struct radixNode *root = getNode(tree, newNodes(tree, 1));
+        root->bitStart = writeNewBits(tree, bitPacked, 0, bitCount);
+        root->numBits = bitCount;
+        root->childPair = NOCHILDPAIR;
+        return NOTPRESENT;
     }
 
     /* Find mismatch */
-    /* Get root. */
-    struct radixTreeNode node = getTreeNode(tree, 0);
+    int nodeIdx;
+    int progress;
+    int i = findMismatch(tree, bitPacked, bitCount, &nodeIdx, &progress);
+    if(i == bitCount) {
+        /* Already present. */
+        return PRESENT;
+    }
+    /* Mismatch, not in tree. Add to tree. */
+    /* The node is split at the mismatch, gaining a pair of children. */
+    int childIdx = newNodes(tree, 2);
+    struct radixNode *node = getNode(tree, nodeIdx);
+    struct radixNode *existingNode;
+    struct radixNode *newNode;
+    if(getBit(bitPacked, i) == 0) {
+        newNode = getNode(tree, childIdx);
+        existingNode = getNode(tree, childIdx + 1);
+    } else {
+        existingNode = getNode(tree, childIdx);
+        newNode = getNode(tree, childIdx + 1);
+    }
+    /* Part 1: Node generated from existing tree, inherits existing children. */
+    existingNode->bitStart = node->bitStart + progress;
+    existingNode->numBits = node->numBits - progress;
+    existingNode->childPair = node->childPair;
+    /* Part 2: Node generated from bit packed insertion. */
+    newNode->bitStart = writeNewBits(tree, bitPacked, i, bitCount - i);
+    newNode->numBits = bitCount - i;
+    newNode->childPair = NOCHILDPAIR;
+    /* Part 0: Split node keeps the common prefix. */
+    node->numBits = progress;
+    node->childPair = (childIdx - 1) / 2;
+    return NOTPRESENT;
+}
 
-    /* Search */
-    int progress = 0;
-    for(int i = 0; i < bitCount; i++) {
-        if(progress == node.numBits){
-            /* Branch. */
-            if(getBit(bitPacked, i) == 0) {
-                node = getTreeNode(tree, node.branchA);
-                progress = 0;
-            } else {
-                node = getTreeNode(tree, node.branchB);
-                progress = 0;
-            }
+/*
+    Writes count (at most 25) left-aligned bits of word into s starting at 
+    bitIndex, in the same order as getBit, leaving the bits around them as
+    they were.
+*/
+static inline void putBits(unsigned char *s, unsigned int bitIndex, uint64_t word, int count) {
+    unsigned char *p = s + bitIndex / BITS_PER_BYTE;
+    int shift = bitIndex % BITS_PER_BYTE;
+    int byteCount = (shift + count + (BITS_PER_BYTE - 1)) / BITS_PER_BYTE;
+    uint32_t value = (uint32_t) (word >> 32) >> shift;
+    uint32_t mask = (~(uint32_t) 0 << (32 - count)) >> shift;
+    for(int i = 0; i < byteCount; i++) {
+        int down = 24 - BITS_PER_BYTE * i;
+        p[i] = (p[i] & ~(mask >> down)) | (value >> down);
+    }
+}
+
+/* 
+    Returns the table of all size-combinations of atom indices, size indices 
+    per row in lexicographic order, building it on first use. 
+*/
+static unsigned char *getCombos(struct radixTree *tree, int size) {
+    if(tree->combos[size]) {
+        return tree->combos[size];
+    }
+    int n = tree->numPieces;
+    /* C(n, size), exact at every step. */
+    long count = 1;
+    for(int i = 1; i <= size; i++) {
+        count = count * (n - size + i) / i;
+    }
+    unsigned char *table = (unsigned char *) malloc(count * size * sizeof(unsigned char));
+    assert(table);
+    unsigned char idx[size];
+    for(int j = 0; j < size; j++) {
+        idx[j] = j;
+    }
+    for(long row = 0; row < count; row++) {
+        memcpy(table + row * size, idx, size);
+        /* Advance the rightmost index not yet at its last position. */
+        int j = size - 1;
+        while(j >= 0 && idx[j] == n - size + j) {
+            j--;
         }
-        if(getBit(tree->prefixBytes, node.bitStart + progress) != getBit(bitPacked, i)){
-            /* Mismatch, not in tree. Add to tree. */
-            /* Part 0: Root node changes. */
-            struct radixTreeNode newRoot;
-            newRoot = node;
-            newRoot.numBits = progress;
-            // newRoot.branchA 
-            // newRoot.branchB
-            /* Part 1: Node generated from bit packed insertion. */
-            struct radixTreeNode newNode;
-            newNode.nodeIdx = tree->nodeCount + 1;
-            newNode.bitStart = tree->prefixBitsUsed;
-            int remainingBits = bitCount - i;
-            newNode.numBits = remainingBits;
-            newNode.branchA = NOCHILD;
-            newNode.branchB = NOCHILD;
-            /* Part 2: Node generated from existing tree. */
-            struct radixTreeNode existingNode;
-            existingNode.nodeIdx = tree->nodeCount;
-            existingNode.bitStart = node.bitStart + progress;
-            int existingRemaining = node.numBits - progress;
-            existingNode.numBits = existingRemaining;
-            /* Inherits existing children. */
-            existingNode.branchA = node.branchA;
-            existingNode.branchB = node.branchB;
-            if(getBit(bitPacked, i) == 0) {
-                newRoot.branchA = newNode.nodeIdx;
-                newRoot.branchB = existingNode.nodeIdx;
-            } else {
-                newRoot.branchA = existingNode.nodeIdx;
-                newRoot.branchB = newNode.nodeIdx;
-            }
-            /* Store prefix data. */
-            writeNewBits(tree, bitPacked, i, remainingBits);
-            /* Store nodes. */
-            storeNode(tree, &existingNode);
-            storeNode(tree, &newNode);
-            storeNode(tree, &newRoot);
-            return;
+        if(j < 0) {
+            break;
+        }
+        idx[j]++;
+        for(int l = j + 1; l < size; l++) {
+            idx[l] = idx[l - 1] + 1;
         }
-        progress++;
     }
+    tree->combos[size] = table;
+    tree->comboCount[size] = count;
+    return table;
 }
 
-void writeNewBitsnCr(unsigned char *destBits, int destFilledBits, unsigned char *bitPacked, int startBit, int bitCount);
+/* 
+    Splits bitPacked into its atoms and returns the combination table for size, 
+    ready for packCombo. 
+*/
+static unsigned char *prepareCombos(struct radixTree *tree, unsigned char *bitPacked, int size, 
+    int atomSize) {
+    assert(size >= 1 && size <= tree->numPieces);
+    assert(atomSize <= 25);
+    for(int i = 0; i < tree->numPieces; i++) {
+        tree->atoms[i] = getBits(bitPacked, atomSize * i, atomSize);
+    }
+    return getCombos(tree, size);
+}
 
-void writeNewBitsnCr(unsigned char *destBits, int destFilledBits, unsigned char *bitPacked, int startBit, int bitCount){
-    for(int i = 0; i < bitCount; i++) {
-        if(getBit(bitPacked, startBit + i) == 0){
-            bitOff(destBits, destFilledBits + i);
-        } else {
-            bitOn(destBits, destFilledBits + i);
-        }
+/* Packs the atoms named by one row of a combination table into the scratch key. */
+static inline void packCombo(struct radixTree *tree, unsigned char *row, int size, int atomSize) {
+    for(int j = 0; j < size; j++) {
+        putBits(tree->partialBitPack, atomSize * j, tree->atoms[row[j]], atomSize);
     }
 }
 
@@ -357,102 +521,320 @@ int checkPresentnCr(struct radixTree *tree, unsigned char *bitPacked, int size)
     int wBits = calcBits(tree->width);
     int atomSize = pBits + hBits + wBits;
 
-    /* Size * atoms, so bits contain location of size pieces. */
-    int bitCount = atomSize * size;
-
-    unsigned char *partialBitPack = (unsigned char *) calloc((bitCount + (BITS_PER_BYTE - 1) / BITS_PER_BYTE), sizeof(unsigned char));
-    assert(partialBitPack);
-
-    /* Stack helper to perform power set. */
-    int packPartial(int remainingSize, int startingAtom) {
-        if(remainingSize <= 0) {
-            if(checkPresent(tree, partialBitPack, size) == NOTPRESENT) {
-                /* Any section being not present is sufficient to determine non-presence. */
-                return NOTPRESENT;
-            }
-            return PRESENT;
-        }
-        for(int i = startingAtom; i <= (tree->numPieces - remainingSize); i++){
-            writeNewBitsnCr(partialBitPack, atomSize * (size - remainingSize), bitPacked, atomSize * i, atomSize);
-            int ppr = packPartial(remainingSize - 1, i + 1);
-            if (ppr == NOTPRESENT){
-                return NOTPRESENT;
-            }
-        }
-        /* Default behaviour - return present */
-        return PRESENT;
-    }
-
-    /* Start from each location */
-    for(int i = 0; i <= (tree->numPieces - size); i++){
-        writeNewBitsnCr(partialBitPack, 0, bitPacked, atomSize * i, atomSize);
-        int ppr = packPartial(size - 1, i + 1);
-        if(ppr == NOTPRESENT) {
-            free(partialBitPack);
+    unsigned char *combos = prepareCombos(tree, bitPacked, size, atomSize);
+    for(int c = 0; c < tree->comboCount[size]; c++) {
+        packCombo(tree, combos + c * size, size, atomSize);
+        if(checkPresent(tree, tree->partialBitPack, size) == NOTPRESENT) {
+            /* Any section being not present is sufficient to determine non-presence. */
             return NOTPRESENT;
         }
     }
-    assert((tree->numPieces - size) >= 0);
-    free(partialBitPack);
     /* No missing atom combinations found. */
     return PRESENT;
 }
 
 /* Inserts sections of appropriate length */
-void insertRadixTreenCr(struct radixTree *tree, unsigned char *bitPacked, int size) {
+int insertRadixTreenCr(struct radixTree *tree, unsigned char *bitPacked, int size) {
     int pBits = calcBits(tree->numPieces);
     int hBits = calcBits(tree->height);
     int wBits = calcBits(tree->width);
     int atomSize = pBits + hBits + wBits;
 
-    /* Size * atoms, so bits contain location of size pieces. */
-    int bitCount = atomSize * size;
+    /* Number of sections which were not yet present. */
+    int inserted = 0;
 
-    unsigned char *partialBitPack = (unsigned char *) calloc((bitCount + (BITS_PER_BYTE - 1) / BITS_PER_BYTE), sizeof(unsigned char));
-    assert(partialBitPack);
+    unsigned char *combos = prepareCombos(tree, bitPacked, size, atomSize);
+    for(int c = 0; c < tree->comboCount[size]; c++) {
+        packCombo(tree, combos + c * size, size, atomSize);
+        if(insertIfAbsent(tree, tree->partialBitPack, size) == NOTPRESENT) {
+            /* New value. */
+            inserted++;
+        }
+    }
+    return inserted;
+}
 
-    /* Stack helper to perform power set. */
-    void packPartial(int remainingSize, int startingAtom) {
-        if(remainingSize <= 0) {
-            if(checkPresent(tree, partialBitPack, size) == NOTPRESENT) {
-                /* New value. */
-                insertRadixTree(tree, partialBitPack, size);
-            }
-            return;
+int insertRadixTreeBatch(struct radixTree *tree, unsigned char *keys, int count, int atomCount, 
+    unsigned char *inserted) {
+    int pBits = calcBits(tree->numPieces);
+    int hBits = calcBits(tree->height);
+    int wBits = calcBits(tree->width);
+    int atomSize = pBits + hBits + wBits;
+    int keyBytes = (atomSize * atomCount + (BITS_PER_BYTE - 1)) / BITS_PER_BYTE;
+
+    if(count > tree->batchCapacity) {
+        tree->batchCapacity = count;
+        tree->batchOrder = (int *) realloc(tree->batchOrder, sizeof(int) * count);
+        assert(tree->batchOrder);
+        tree->batchScratch = (int *) realloc(tree->batchScratch, sizeof(int) * count);
+        assert(tree->batchScratch);
+    }
+    /* 
+        Sort by key with an LSD radix sort over the key bytes. Bytes compare in
+        the tree's bit order, and the sort is stable, so equal keys stay in 
+        input order. 
+    */
+    int *order = tree->batchOrder;
+    int *sorted = tree->batchScratch;
+    for(int i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    for(int b = keyBytes - 1; b >= 0; b--) {
+        int start[256 + 1] = {0};
+        for(int i = 0; i < count; i++) {
+            start[keys[(size_t) i * keyBytes + b] + 1]++;
+        }
+        for(int v = 0; v < 256; v++) {
+            start[v + 1] += start[v];
         }
-        for(int i = startingAtom; i <= (tree->numPieces - remainingSize); i++){
-            writeNewBitsnCr(partialBitPack, atomSize * (size - remainingSize), bitPacked, atomSize * i, atomSize);
-            packPartial(remainingSize - 1, i + 1);
+        for(int i = 0; i < count; i++) {
+            int k = order[i];
+            sorted[start[keys[(size_t) k * keyBytes + b]]++] = k;
         }
+        int *t = order;
+        order = sorted;
+        sorted = t;
     }
 
-    /* Start from each location */
-    for(int i = 0; i <= (tree->numPieces - size); i++){
-        writeNewBitsnCr(partialBitPack, 0, bitPacked, atomSize * i, atomSize);
-        packPartial(size - 1, i + 1);
+    /* 
+        Sweep in key order, so consecutive walks share their path from the 
+        root. A key equal to the one before it is a duplicate within the batch.
+    */
+    int newKeys = 0;
+    unsigned char *prev = NULL;
+    for(int i = 0; i < count; i++) {
+        int k = order[i];
+        unsigned char *key = keys + (size_t) k * keyBytes;
+        if(prev && memcmp(prev, key, keyBytes) == 0) {
+            inserted[k] = 0;
+            continue;
+        }
+        inserted[k] = (insertIfAbsent(tree, key, atomCount) == NOTPRESENT);
+        newKeys += inserted[k];
+        prev = key;
     }
-    assert((tree->numPieces - size) >= 0);
-    free(partialBitPack);
+    return newKeys;
 }
 
-void freeRadixTree(struct radixTree *tree) {
-    if(! tree) {
-        return;
+/* Bytes of prefix page page holding bits, the last page being partly used. */
+static size_t prefixPageBytes(struct radixTree *tree, int page) {
+    if(page < tree->prefixPageCount - 1) {
+        return PREFIXPAGESIZE / BITS_PER_BYTE;
+    }
+    uint64_t bits = tree->prefixBitsUsed - (uint64_t) page * PREFIXPAGESIZE;
+    return (bits + (BITS_PER_BYTE - 1)) / BITS_PER_BYTE;
+}
+
+/* Nodes held in node page page, the last page being partly used. */
+static int nodePageNodes(struct radixTree *tree, int page) {
+    int nodes = tree->nodeCount - page * NODEPAGESIZE;
+    return nodes < NODEPAGESIZE ? nodes : NODEPAGESIZE;
+}
+
+int saveRadixTree(struct radixTree *tree, char const *path) {
+    FILE *f = fopen(path, "wb");
+    if(! f) {
+        return -1;
+    }
+    struct radixSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOTMAGIC, sizeof(SNAPSHOTMAGIC));
+    header.nodeRecordSize = sizeof(struct radixNode);
+    header.nodePageBits = NODEPAGEBITS;
+    header.prefixPageBits = PREFIXPAGEBITS;
+    header.numPieces = tree->numPieces;
+    header.height = tree->height;
+    header.width = tree->width;
+    header.nodeCount = tree->nodeCount;
+    header.prefixPageCount = tree->prefixPageCount;
+    header.prefixBitsUsed = tree->prefixBitsUsed;
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    /* Node pages back to back, so they form one array of records. */
+    for(int i = 0; ok && i < tree->nodePageCount; i++) {
+        size_t nodes = nodePageNodes(tree, i);
+        ok = fwrite(tree->nodePages[i], sizeof(struct radixNode), nodes, f) == nodes;
     }
-    if(tree->prefixBytes) {
-        free(tree->prefixBytes);
+    /* Prefix pages, full but for the last, then padding for word reads. */
+    for(int i = 0; ok && i < tree->prefixPageCount; i++) {
+        size_t bytes = prefixPageBytes(tree, i);
+        ok = fwrite(tree->prefixPages[i], 1, bytes, f) == bytes;
     }
-    if(tree->prefixBitsBytes) {
-        free(tree->prefixBitsBytes);
+    unsigned char pad[PREFIXPAGEPAD] = {0};
+    ok = ok && fwrite(pad, 1, PREFIXPAGEPAD, f) == PREFIXPAGEPAD;
+    if(fclose(f) != 0) {
+        ok = 0;
     }
-    if(tree->prefixBitStartBytes) {
-        free(tree->prefixBitStartBytes);
+    return ok ? 0 : -1;
+}
+
+/*
+    Checks the node records of a loaded tree, so that no walk can leave the
+    node or prefix pages: walking down from the root, every prefix lies 
+    inside the pool and within one page, every child pair inside the node 
+    records, no node is reached twice and every path ends in a leaf exactly
+    one full key deep.
+*/
+static int validNodes(struct radixTree *tree) {
+    if(tree->nodeCount == 0) {
+        return 1;
+    }
+    int keyBits = (calcBits(tree->numPieces) + calcBits(tree->height) 
+        + calcBits(tree->width)) * tree->numPieces;
+    /* Depth of each node's last prefix bit, -1 until the walk reaches it. */
+    int *depth = (int *) malloc(sizeof(int) * tree->nodeCount);
+    int *stack = (int *) malloc(sizeof(int) * tree->nodeCount);
+    assert(depth && stack);
+    for(int i = 0; i < tree->nodeCount; i++) {
+        depth[i] = -1;
+    }
+    depth[0] = getNode(tree, 0)->numBits;
+    stack[0] = 0;
+    int stackSize = 1;
+    int valid = 1;
+    while(valid && stackSize > 0) {
+        int i = stack[--stackSize];
+        struct radixNode *node = getNode(tree, i);
+        uint64_t start = node->bitStart;
+        valid = start + node->numBits <= tree->prefixBitsUsed
+            && (start & (PREFIXPAGESIZE - 1)) + node->numBits <= PREFIXPAGESIZE;
+        if(! valid) {
+            break;
+        }
+        if(node->childPair == NOCHILDPAIR) {
+            valid = depth[i] == keyBits;
+            continue;
+        }
+        uint64_t childIdx = 1 + 2 * (uint64_t) node->childPair;
+        valid = depth[i] < keyBits && childIdx + 1 < (uint64_t) tree->nodeCount;
+        for(int c = 0; valid && c < 2; c++) {
+            int child = (int) childIdx + c;
+            /* A child's prefix holds at least its branching bit. */
+            valid = depth[child] < 0 && getNode(tree, child)->numBits > 0;
+            if(valid) {
+                depth[child] = depth[i] + getNode(tree, child)->numBits;
+                stack[stackSize++] = child;
+            }
+        }
+    }
+    free(depth);
+    free(stack);
+    return valid;
+}
+
+struct radixTree *loadRadixTree(char const *path, int numPieces, int height, int width) {
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return NULL;
+    }
+    struct stat st;
+    if(fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(struct radixSnapshotHeader)) {
+        close(fd);
+        return NULL;
+    }
+    size_t length = st.st_size;
+    unsigned char *base = (unsigned char *) mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    /* The mapping stays valid once the file is closed. */
+    close(fd);
+    if(base == MAP_FAILED) {
+        return NULL;
+    }
+    struct radixSnapshotHeader header;
+    memcpy(&header, base, sizeof(header));
+    /* 
+        Everything the page tables and getNewRadixTree are built from is
+        checked here, and the node records once the tables are built, so a 
+        damaged file cannot point outside the mapping.
+    */
+    int valid = memcmp(header.magic, SNAPSHOTMAGIC, sizeof(SNAPSHOTMAGIC)) == 0 
+        && header.nodeRecordSize == sizeof(struct radixNode)
+        && header.nodePageBits == NODEPAGEBITS 
+        && header.prefixPageBits == PREFIXPAGEBITS
+        && header.numPieces >= 1 && header.numPieces <= MAX_PIECES
+        && header.height > 0 && header.width > 0
+        && header.numPieces == numPieces && header.height == height && header.width == width
+        && header.nodeCount >= 0
+        && header.prefixBitsUsed <= (uint64_t) length * BITS_PER_BYTE
+        && (uint64_t) header.prefixPageCount 
+            == (header.prefixBitsUsed + PREFIXPAGESIZE - 1) / PREFIXPAGESIZE;
+    size_t nodeBytes = (size_t) header.nodeCount * sizeof(struct radixNode);
+    size_t prefixBytes = (header.prefixBitsUsed + (BITS_PER_BYTE - 1)) / BITS_PER_BYTE;
+    if(! valid || length != sizeof(header) + nodeBytes + prefixBytes + PREFIXPAGEPAD) {
+        munmap(base, length);
+        return NULL;
     }
-    if(tree->branchABytes) {
-        free(tree->branchABytes);
+
+    struct radixTree *tree = getNewRadixTree(header.numPieces, header.height, header.width);
+    tree->mapping = base;
+    tree->mappingLength = length;
+    /* Point the page tables into the mapping, nothing is copied. */
+    tree->nodeCount = header.nodeCount;
+    tree->nodePageCount = (header.nodeCount + NODEPAGESIZE - 1) / NODEPAGESIZE;
+    tree->nodePageCapacity = tree->nodePageCount;
+    tree->nodePages = (struct radixNode **) malloc(sizeof(struct radixNode *) * (tree->nodePageCount + 1));
+    assert(tree->nodePages);
+    struct radixNode *nodes = (struct radixNode *) (base + sizeof(header));
+    for(int i = 0; i < tree->nodePageCount; i++) {
+        tree->nodePages[i] = nodes + (size_t) i * NODEPAGESIZE;
+    }
+    tree->prefixBitsUsed = header.prefixBitsUsed;
+    tree->prefixPageCount = header.prefixPageCount;
+    tree->prefixPageCapacity = tree->prefixPageCount;
+    tree->prefixPages = (unsigned char **) malloc(sizeof(unsigned char *) * (tree->prefixPageCount + 1));
+    assert(tree->prefixPages);
+    unsigned char *prefix = base + sizeof(header) + nodeBytes;
+    for(int i = 0; i < tree->prefixPageCount; i++) {
+        tree->prefixPages[i] = prefix + (size_t) i * (PREFIXPAGESIZE / BITS_PER_BYTE);
+    }
+    if(! validNodes(tree)) {
+        freeRadixTree(tree);
+        return NULL;
+    }
+    return tree;
+}
+
+/* Copies every page of a loaded tree out of its mapping, then unmaps it. */
+static void thawRadixTree(struct radixTree *tree) {
+    for(int i = 0; i < tree->nodePageCount; i++) {
+        struct radixNode *page = (struct radixNode *) malloc(NODEPAGESIZE * sizeof(struct radixNode));
+        assert(page);
+        memcpy(page, tree->nodePages[i], nodePageNodes(tree, i) * sizeof(struct radixNode));
+        tree->nodePages[i] = page;
+    }
+    for(int i = 0; i < tree->prefixPageCount; i++) {
+        unsigned char *page = (unsigned char *) calloc(1, PREFIXPAGESIZE / BITS_PER_BYTE + PREFIXPAGEPAD);
+        assert(page);
+        memcpy(page, tree->prefixPages[i], prefixPageBytes(tree, i));
+        tree->prefixPages[i] = page;
+    }
+    munmap(tree->mapping, tree->mappingLength);
+    tree->mapping = NULL;
+    tree->mappingLength = 0;
+}
+
+void freeRadixTree(struct radixTree *tree) {
+    if(! tree) {
+        return;
+    }
+    if(tree->mapping) {
+        munmap(tree->mapping, tree->mappingLength);
+    } else {
+        for(int i = 0; i < tree->nodePageCount; i++) {
+            free(tree->nodePages[i]);
+        }
+        for(int i = 0; i < tree->prefixPageCount; i++) {
+            free(tree->prefixPages[i]);
+        }
     }
-    if(tree->branchBBytes) {
-        free(tree->branchBBytes);
+    free(tree->nodePages);
+    free(tree->prefixPages);
+    for(int k = 0; k <= tree->numPieces; k++) {
+        free(tree->combos[k]);
     }
+    free(tree->combos);
+    free(tree->comboCount);
+    free(tree->atoms);
+    free(tree->partialBitPack);
+    free(tree->batchOrder);
+    free(tree->batchScratch);
     free(tree);
 }
@@ -47,11 +47,50 @@ int checkPresent(struct radixTree *tree, unsigned char *bitPacked, int atomCount
 /* Inserts the state into the radix tree. */
 void insertRadixTree(struct radixTree *tree, unsigned char *bitPacked, int atomCount);
 
+/* 
+	Inserts the state into the radix tree if it is not already there, in a 
+	single walk of the tree. Returns PRESENT if the state was already in the 
+	tree, NOTPRESENT if it was just inserted.
+*/
+int insertIfAbsent(struct radixTree *tree, unsigned char *bitPacked, int atomCount);
+
+/*
+	Inserts a batch of count states, such as a whole BFS layer, stored back to 
+	back in keys, each taking the whole bytes needed for atomCount atoms (pad 
+	bits zero). The batch is sorted and merged into the tree in key order, so 
+	nearby keys are inserted together. Sets inserted[i] to 1 if key i was 
+	neither in the tree nor earlier in the batch, 0 otherwise, and returns the 
+	number of keys inserted.
+*/
+int insertRadixTreeBatch(struct radixTree *tree, unsigned char *keys, int count, int atomCount, 
+	unsigned char *inserted);
+
 /* Checks if all state sections of length s are in the radix tree. */
 int checkPresentnCr(struct radixTree *tree, unsigned char *bitPacked, int size);
 
-/* Inserts all sections of appropriate length s */
-void insertRadixTreenCr(struct radixTree *tree, unsigned char *bitPacked, int size);
+/* 
+	Inserts all sections of appropriate length s, returning how many were not
+	already present (0 if the state is not novel at size s).
+*/
+int insertRadixTreenCr(struct radixTree *tree, unsigned char *bitPacked, int size);
+
+/* 
+	Writes a snapshot of the tree to the file at path, returning 0 on success 
+	and -1 if the file could not be written. The format is the tree's own 
+	in-memory layout, so is only read back by the same build on the same 
+	architecture.
+*/
+int saveRadixTree(struct radixTree *tree, char const *path);
+
+/* 
+	Opens a snapshot written by saveRadixTree, mapping the file read-only 
+	rather than rebuilding the tree, so lookups start straight away. The first 
+	insertion copies the tree into memory of its own. Returns NULL if the file 
+	cannot be mapped, is not a snapshot for this build, has a header or node 
+	records that do not match its contents or holds states of a different 
+	size than numPieces, height and width give.
+*/
+struct radixTree *loadRadixTree(char const *path, int numPieces, int height, int width);
 
 /* Free radix tree */
 void freeRadixTree(struct radixTree *tree);
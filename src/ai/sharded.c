@@ -0,0 +1,95 @@
+#include "sharded.h"
+#include "radix.h"
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include <pthread.h>
+
+/* Cache line size, shards are padded to it so locks do not share lines. */
+#define CACHELINE 64
+
+struct shard {
+    pthread_mutex_t lock;
+    struct radixTree *tree;
+} __attribute__((aligned(CACHELINE)));
+
+struct shardedRadix {
+    int shardCount;
+    /* Bits per atom, to find a key's length from its atom count. */
+    int atomSize;
+    struct shard *shards;
+};
+
+struct shardedRadix *newShardedRadix(int numPieces, int height, int width, int shardCount) {
+    assert(shardCount > 0 && (shardCount & (shardCount - 1)) == 0);
+    struct shardedRadix *set = (struct shardedRadix *) malloc(sizeof(struct shardedRadix));
+    assert(set);
+    set->shardCount = shardCount;
+    set->atomSize = calcBits(numPieces) + calcBits(height) + calcBits(width);
+    set->shards = (struct shard *) aligned_alloc(CACHELINE, sizeof(struct shard) * shardCount);
+    assert(set->shards);
+    for(int i = 0; i < shardCount; i++) {
+        pthread_mutex_init(&set->shards[i].lock, NULL);
+        set->shards[i].tree = getNewRadixTree(numPieces, height, width);
+    }
+    return set;
+}
+
+/* 
+    Shard of a key. The leading bits of a packed state are the index of piece
+    0, the same in every state, so the whole key is hashed (FNV-1a).
+*/
+int shardedShardOf(struct shardedRadix *set, unsigned char *bitPacked, int atomCount) {
+    int keyBytes = (set->atomSize * atomCount + 7) / 8;
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for(int i = 0; i < keyBytes; i++) {
+        h ^= bitPacked[i];
+        h *= 0x100000001B3ULL;
+    }
+    h ^= h >> 32;
+    return (int) (h & (set->shardCount - 1));
+}
+
+static struct shard *getShard(struct shardedRadix *set, unsigned char *bitPacked, int atomCount) {
+    return &set->shards[shardedShardOf(set, bitPacked, atomCount)];
+}
+
+int shardedCheckPresent(struct shardedRadix *set, unsigned char *bitPacked, int atomCount) {
+    struct shard *shard = getShard(set, bitPacked, atomCount);
+    pthread_mutex_lock(&shard->lock);
+    int present = checkPresent(shard->tree, bitPacked, atomCount);
+    pthread_mutex_unlock(&shard->lock);
+    return present;
+}
+
+int shardedCheckPresentUnlocked(struct shardedRadix *set, unsigned char *bitPacked, int atomCount) {
+    return checkPresent(getShard(set, bitPacked, atomCount)->tree, bitPacked, atomCount);
+}
+
+int shardedInsertIfAbsent(struct shardedRadix *set, unsigned char *bitPacked, int atomCount) {
+    struct shard *shard = getShard(set, bitPacked, atomCount);
+    pthread_mutex_lock(&shard->lock);
+    int present = insertIfAbsent(shard->tree, bitPacked, atomCount);
+    pthread_mutex_unlock(&shard->lock);
+    return present;
+}
+
+int queryShardedMemoryUsage(struct shardedRadix *set) {
+    int memoryUsage = 0;
+    for(int i = 0; i < set->shardCount; i++) {
+        memoryUsage += queryRadixMemoryUsage(set->shards[i].tree);
+    }
+    return memoryUsage;
+}
+
+void freeShardedRadix(struct shardedRadix *set) {
+    if(! set) {
+        return;
+    }
+    for(int i = 0; i < set->shardCount; i++) {
+        pthread_mutex_destroy(&set->shards[i].lock);
+        freeRadixTree(set->shards[i].tree);
+    }
+    free(set->shards);
+    free(set);
+}
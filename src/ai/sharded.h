@@ -0,0 +1,44 @@
+/*
+ * Visited set safe to share between threads: packed states are spread over
+ * independent radix trees by a hash of their bytes, each tree guarded by its
+ * own lock, so threads only contend when they touch the same shard.
+*/
+#ifndef __SHARDED__
+#define __SHARDED__
+
+struct shardedRadix;
+
+/*
+	Creates an empty set of shardCount (a power of two) radix trees, arguments 
+	otherwise as getNewRadixTree.
+*/
+struct shardedRadix *newShardedRadix(int numPieces, int height, int width, int shardCount);
+
+/* 
+	Index of the shard holding the state, from 0 to shardCount - 1. Callers 
+	can split work by shard so that each shard is only used by one thread.
+*/
+int shardedShardOf(struct shardedRadix *set, unsigned char *bitPacked, int atomCount);
+
+/* Checks if the state is present, as checkPresent. Thread-safe. */
+int shardedCheckPresent(struct shardedRadix *set, unsigned char *bitPacked, int atomCount);
+
+/* 
+	Checks if the state is present without taking the shard's lock. Any 
+	number of threads may call it at once, but only while none inserts.
+*/
+int shardedCheckPresentUnlocked(struct shardedRadix *set, unsigned char *bitPacked, int atomCount);
+
+/* 
+	Inserts the state unless present, as insertIfAbsent: returns PRESENT if it 
+	was already there, NOTPRESENT if it was just inserted. Thread-safe.
+*/
+int shardedInsertIfAbsent(struct shardedRadix *set, unsigned char *bitPacked, int atomCount);
+
+/* Return memory used in all shards, as queryRadixMemoryUsage. */
+int queryShardedMemoryUsage(struct shardedRadix *set);
+
+/* Free set, no thread may be using it. */
+void freeShardedRadix(struct shardedRadix *set);
+
+#endif
@@ -0,0 +1,129 @@
+#include "stateset.h"
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define INITIALSLOTS 1024
+/* Tag of an empty slot, tags of stored keys always have the low bit set. */
+#define EMPTYTAG 0
+/* Grow when more than 7/10 of the slots are used. */
+#define MAXLOADNUM 7
+#define MAXLOADDEN 10
+
+struct stateSet {
+    int keyBytes;
+    /* Power of two so a hash maps to a slot with a mask. */
+    uint64_t slotCount;
+    uint64_t used;
+    /* Upper hash bits of each slot's key, rejects most mismatches unread. */
+    uint32_t *tags;
+    /* slotCount keys of keyBytes bytes each, slot i at i * keyBytes. */
+    unsigned char *keys;
+};
+
+struct stateSet *newStateSet(int keyBits) {
+    struct stateSet *set = (struct stateSet *) malloc(sizeof(struct stateSet));
+    assert(set);
+    /* packMap never writes the padding bits, callers keep them zeroed. */
+    set->keyBytes = (keyBits + 7) / 8;
+    set->slotCount = INITIALSLOTS;
+    set->used = 0;
+    set->tags = (uint32_t *) calloc(INITIALSLOTS, sizeof(uint32_t));
+    assert(set->tags);
+    set->keys = (unsigned char *) malloc(INITIALSLOTS * set->keyBytes);
+    assert(set->keys);
+    return set;
+}
+
+/* FNV-1a over the key bytes, then a final mix so both halves are usable. */
+static uint64_t hashKey(unsigned char *packed, int keyBytes) {
+    uint64_t h = 0xCBF29CE484222325ULL;
+    for(int i = 0; i < keyBytes; i++) {
+        h ^= packed[i];
+        h *= 0x100000001B3ULL;
+    }
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint32_t tagOf(uint64_t h) {
+    return (uint32_t) (h >> 32) | 1;
+}
+
+/* Slot holding the key, or the empty slot where it would go. Linear probing. */
+static uint64_t findSlot(struct stateSet *set, unsigned char *packed, uint64_t h) {
+    uint64_t mask = set->slotCount - 1;
+    uint64_t idx = h & mask;
+    uint32_t tag = tagOf(h);
+    while(set->tags[idx] != EMPTYTAG) {
+        if(set->tags[idx] == tag 
+            && memcmp(set->keys + idx * set->keyBytes, packed, set->keyBytes) == 0) {
+            break;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return idx;
+}
+
+bool stateSetContains(struct stateSet *set, unsigned char *packed) {
+    uint64_t idx = findSlot(set, packed, hashKey(packed, set->keyBytes));
+    return set->tags[idx] != EMPTYTAG;
+}
+
+/* Doubles the table, rehashing every key into the new arrays. */
+static void growStateSet(struct stateSet *set) {
+    uint64_t oldCount = set->slotCount;
+    uint32_t *oldTags = set->tags;
+    unsigned char *oldKeys = set->keys;
+    set->slotCount = oldCount * 2;
+    set->tags = (uint32_t *) calloc(set->slotCount, sizeof(uint32_t));
+    assert(set->tags);
+    set->keys = (unsigned char *) malloc(set->slotCount * set->keyBytes);
+    assert(set->keys);
+    uint64_t mask = set->slotCount - 1;
+    for(uint64_t i = 0; i < oldCount; i++) {
+        if(oldTags[i] == EMPTYTAG) {
+            continue;
+        }
+        unsigned char *key = oldKeys + i * set->keyBytes;
+        uint64_t idx = hashKey(key, set->keyBytes) & mask;
+        /* Keys are distinct, so the first empty slot is the right one. */
+        while(set->tags[idx] != EMPTYTAG) {
+            idx = (idx + 1) & mask;
+        }
+        set->tags[idx] = oldTags[i];
+        memcpy(set->keys + idx * set->keyBytes, key, set->keyBytes);
+    }
+    free(oldTags);
+    free(oldKeys);
+}
+
+bool stateSetInsert(struct stateSet *set, unsigned char *packed) {
+    uint64_t h = hashKey(packed, set->keyBytes);
+    uint64_t idx = findSlot(set, packed, h);
+    if(set->tags[idx] != EMPTYTAG) {
+        return false;
+    }
+    set->tags[idx] = tagOf(h);
+    memcpy(set->keys + idx * set->keyBytes, packed, set->keyBytes);
+    set->used++;
+    if(set->used * MAXLOADDEN > set->slotCount * MAXLOADNUM) {
+        growStateSet(set);
+    }
+    return true;
+}
+
+int queryStateSetMemoryUsage(struct stateSet *set) {
+    return set->slotCount * (sizeof(uint32_t) + set->keyBytes);
+}
+
+void freeStateSet(struct stateSet *set) {
+    if(! set) {
+        return;
+    }
+    free(set->tags);
+    free(set->keys);
+    free(set);
+}
@@ -0,0 +1,33 @@
+/*
+ * Open-addressing set of packed states, the bytes written by packMap. Keys
+ * live back to back in one flat array next to a 32-bit tag per slot, so a
+ * lookup is a hash and a short linear probe over contiguous memory. An
+ * alternative to the radix tree, trading memory for lookup speed.
+*/
+#ifndef __STATESET__
+#define __STATESET__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+struct stateSet;
+
+/* Creates an empty set of keys of keyBits bits (the packMap bit count). */
+struct stateSet *newStateSet(int keyBits);
+
+/* Checks if the packed state is in the set. */
+bool stateSetContains(struct stateSet *set, unsigned char *packed);
+
+/* Inserts the packed state, returning true if it was not already present. */
+bool stateSetInsert(struct stateSet *set, unsigned char *packed);
+
+/* 
+    Return memory used by the set's tag and key arrays, counted the same way 
+    as queryRadixMemoryUsage (metadata not counted).
+*/
+int queryStateSetMemoryUsage(struct stateSet *set);
+
+/* Free set */
+void freeStateSet(struct stateSet *set);
+
+#endif
@@ -0,0 +1,102 @@
+/*
+** COMP20003 Assignment 3 2025
+** bench.c
+** File description:
+** Times the move engines on the same random walk over a puzzle:
+** move_location (full board scans), move_piece (footprints) and
+** bitstate_move (bitboards).
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <sys/time.h>
+#include "../include/gate.h"
+#include "../include/bitboard.h"
+
+#define DEFAULT_MOVES 1000000
+
+static double seconds(void) {
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return (double) tv.tv_sec + (double) tv.tv_usec * 1e-6;
+}
+
+static gate_t copy_state(gate_t gate) {
+	char **map = malloc(sizeof(char *) * gate.lines);
+	char **map_save = malloc(sizeof(char *) * gate.lines);
+	for (int i = 0; i < gate.lines; i++) {
+		map[i] = strdup(gate.map[i]);
+		map_save[i] = strdup(gate.map_save[i]);
+	}
+	gate.map = map;
+	gate.map_save = map_save;
+	return (gate);
+}
+
+static void report(char const *name, double elapsed, int moves, long made) {
+	printf("%-14s %10.1f ns/move %12.0f moves/s (%ld made)\n", name,
+		elapsed * 1e9 / moves, moves / elapsed, made);
+}
+
+int main(int argc, char const **argv) {
+	if (argc < 2 || argc > 3) {
+		fprintf(stderr, "USAGE\n\t./gate_bench puzzle [moves]\n");
+		return (84);
+	}
+	int moves = argc == 3 ? atoi(argv[2]) : DEFAULT_MOVES;
+	gate_t gate;
+	memset(&gate, 0, sizeof(gate_t));
+	gate = make_map(argv[1], gate);
+	map_check(gate);
+	gate = find_pieces(gate);
+	gate.board = make_board(gate);
+
+	// Same walk for every engine.
+	char const directions[] = "udlr";
+	int *pieces = malloc(sizeof(int) * moves);
+	char *dirs = malloc(moves);
+	assert(pieces && dirs);
+	srand(20003);
+	for (int i = 0; i < moves; i++) {
+		pieces[i] = rand() % gate.num_pieces;
+		dirs[i] = directions[rand() % 4];
+	}
+
+	gate_t scan = copy_state(gate);
+	long made = 0;
+	double start = seconds();
+	for (int i = 0; i < moves; i++) {
+		scan = move_location(scan, '0' + pieces[i], dirs[i]);
+		made += scan.move_status == MOVE_MADE;
+	}
+	report("move_location", seconds() - start, moves, made);
+
+	gate_t footprint = copy_state(gate);
+	made = 0;
+	start = seconds();
+	for (int i = 0; i < moves; i++) {
+		made += move_piece(&footprint, pieces[i], dirs[i]);
+	}
+	report("move_piece", seconds() - start, moves, made);
+
+	bitstate_t bits;
+	bitstate_init(&bits, gate.board);
+	bitstate_place(&bits, gate.piece_x, gate.piece_y);
+	made = 0;
+	start = seconds();
+	for (int i = 0; i < moves; i++) {
+		made += bitstate_move(&bits, pieces[i], dirs[i]);
+	}
+	report("bitstate_move", seconds() - start, moves, made);
+
+	// All engines must end in the same position.
+	for (int p = 0; p < gate.num_pieces; p++) {
+		assert(scan.piece_x[p] == footprint.piece_x[p]);
+		assert(scan.piece_y[p] == footprint.piece_y[p]);
+		assert(bits.piece_x[p] == footprint.piece_x[p]);
+		assert(bits.piece_y[p] == footprint.piece_y[p]);
+	}
+	return (0);
+}
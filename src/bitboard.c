@@ -0,0 +1,106 @@
+/*
+** COMP20003 Assignment 3 2025
+** bitboard.c
+** File description:
+** Move engine working on bitboards. A move shifts the piece mask and is
+** legal when the shifted mask misses the walls and every other piece.
+*/
+
+#include <string.h>
+#include "../include/bitboard.h"
+
+static void set_bit(bitboard_t *mask, int cell) {
+	mask->word[cell >> 6] |= (uint64_t) 1 << (cell & 63);
+}
+
+// Shift every bit of in by shift cells, towards higher cells if positive.
+// |shift| is at most one row, so it is always below 64.
+static void shift_mask(bitboard_t const *in, int shift, bitboard_t *out) {
+	if (shift > 0) {
+		for (int i = BB_WORDS - 1; i > 0; i--) {
+			out->word[i] = (in->word[i] << shift)
+				| (in->word[i - 1] >> (64 - shift));
+		}
+		out->word[0] = in->word[0] << shift;
+	} else {
+		shift = -shift;
+		for (int i = 0; i < BB_WORDS - 1; i++) {
+			out->word[i] = (in->word[i] >> shift)
+				| (in->word[i + 1] << (64 - shift));
+		}
+		out->word[BB_WORDS - 1] = in->word[BB_WORDS - 1] >> shift;
+	}
+}
+
+void bitstate_init(bitstate_t *bits, board_t const *board) {
+	memset(bits, 0, sizeof(bitstate_t));
+	bits->board = board;
+	for (int cell = 0; cell < board->lines * board->columns; cell++) {
+		if (board->cells[cell] == '#') {
+			set_bit(&bits->walls, cell);
+		} else if (board->cells[cell] == 'G') {
+			set_bit(&bits->goals, cell);
+		}
+	}
+}
+
+void bitstate_place(bitstate_t *bits, int const *piece_x, int const *piece_y) {
+	board_t const *board = bits->board;
+	memset(&bits->occupied, 0, sizeof(bitboard_t));
+	for (int p = 0; p < board->num_pieces; p++) {
+		int anchor = piece_y[p] * board->columns + piece_x[p];
+		memset(&bits->pieces[p], 0, sizeof(bitboard_t));
+		for (int k = 0; k < board->footprint_size[p]; k++) {
+			set_bit(&bits->pieces[p], anchor + board->footprint[p][k]);
+		}
+		for (int i = 0; i < BB_WORDS; i++) {
+			bits->occupied.word[i] |= bits->pieces[p].word[i];
+		}
+		bits->piece_x[p] = piece_x[p];
+		bits->piece_y[p] = piece_y[p];
+	}
+}
+
+// Same rules as move_piece. Returns 1 if the piece moved.
+int bitstate_move(bitstate_t *bits, int piece, char direction) {
+	int dy = 0;
+	int dx = 0;
+	if (direction == 'u') {
+		dy = -1;
+	} else if (direction == 'd') {
+		dy = 1;
+	} else if (direction == 'l') {
+		dx = -1;
+	} else if (direction == 'r') {
+		dx = 1;
+	} else {
+		return (0);
+	}
+	bitboard_t moved;
+	bitboard_t *mask = &bits->pieces[piece];
+	shift_mask(mask, dy * bits->board->columns + dx, &moved);
+	uint64_t blocked = 0;
+	for (int i = 0; i < BB_WORDS; i++) {
+		uint64_t others = bits->occupied.word[i] ^ mask->word[i];
+		blocked |= moved.word[i] & (bits->walls.word[i] | others);
+	}
+	if (blocked) {
+		return (0);
+	}
+	for (int i = 0; i < BB_WORDS; i++) {
+		bits->occupied.word[i] ^= mask->word[i] ^ moved.word[i];
+	}
+	*mask = moved;
+	bits->piece_x[piece] += dx;
+	bits->piece_y[piece] += dy;
+	return (1);
+}
+
+// Won when piece 0 covers every goal, as in is_won.
+int bitstate_won(bitstate_t const *bits) {
+	uint64_t uncovered = 0;
+	for (int i = 0; i < BB_WORDS; i++) {
+		uncovered |= bits->goals.word[i] & ~bits->pieces[0].word[i];
+	}
+	return (uncovered == 0);
+}
@@ -0,0 +1,124 @@
+/*
+** COMP20003 Assignment 3 2025
+** board.c
+** File description:
+** Read-only board layer shared by every search state: walls, goal
+** locations and the shape of each piece relative to its anchor cell.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "../include/gate.h"
+
+// Fixed seed so keys, and anything derived from them, are reproducible.
+#define ZOBRIST_SEED 0x20003ULL
+
+// splitmix64, enough to spread bits for Zobrist keys.
+static uint64_t next_key(uint64_t *seed) {
+	uint64_t z = (*seed += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return (z ^ (z >> 31));
+}
+
+board_t *make_board(gate_t gate) {
+	board_t *board = malloc(sizeof(board_t));
+	assert(board);
+	board->lines = gate.lines;
+	board->columns = gate.num_chars_map / gate.lines;
+	board->num_pieces = gate.num_pieces;
+	board->num_goals = 0;
+	board->empty_spaces = 0;
+	for (int p = 0; p < MAX_PIECES; p++) {
+		board->footprint_size[p] = 0;
+	}
+	for (int i = 0; i < gate.lines; i++) {
+		// Cells are addressed as y * columns + x, so rows must line up.
+		assert((int) strlen(gate.map[i]) == board->columns);
+		for (int j = 0; j < board->columns; j++) {
+			char tile = gate.map[i][j];
+			int cell = i * board->columns + j;
+			int piece = -1;
+			if (tile >= '0' && tile <= '9') {
+				piece = tile - '0';
+				tile = ' ';
+			} else if (tile >= 'H' && tile <= 'Q') {
+				piece = tile - 'H';
+				tile = 'G';
+			} else if (tile == ' ') {
+				board->empty_spaces++;
+			}
+			if (tile == 'G') {
+				board->num_goals++;
+			}
+			board->cells[cell] = tile;
+			if (piece >= 0) {
+				// The anchor is the first cell of the piece in row-major
+				// order, so every offset is non-negative.
+				int anchor = gate.piece_y[piece] * board->columns
+					+ gate.piece_x[piece];
+				int k = board->footprint_size[piece]++;
+				board->footprint[piece][k] = cell - anchor;
+				board->footprint_dy[piece][k] = i - gate.piece_y[piece];
+				board->footprint_dx[piece][k] = j - gate.piece_x[piece];
+			}
+		}
+	}
+	uint64_t seed = ZOBRIST_SEED;
+	for (int p = 0; p < MAX_PIECES; p++) {
+		for (int cell = 0; cell < MAX_CELLS; cell++) {
+			board->zobrist[p][cell] = next_key(&seed);
+		}
+	}
+	// Piece 0 is the only piece that can achieve a goal, so the number of
+	// goals it covers depends on its anchor alone.
+	for (int anchor = 0; anchor < board->lines * board->columns; anchor++) {
+		board->goal_cover[anchor] = 0;
+		for (int k = 0; k < board->footprint_size[0]; k++) {
+			int cell = anchor + board->footprint[0][k];
+			if (cell < board->lines * board->columns
+				&& board->cells[cell] == 'G') {
+				board->goal_cover[anchor]++;
+			}
+		}
+	}
+	return (board);
+}
+
+int count_open_goals(board_t const *board, int piece_y, int piece_x) {
+	return (board->num_goals
+		- board->goal_cover[piece_y * board->columns + piece_x]);
+}
+
+// Full Zobrist key of a position, make_move keeps it up to date from there.
+uint64_t hash_pieces(board_t const *board, int const *piece_y,
+	int const *piece_x) {
+	uint64_t hash = 0;
+	for (int p = 0; p < board->num_pieces; p++) {
+		hash ^= board->zobrist[p][piece_y[p] * board->columns + piece_x[p]];
+	}
+	return (hash);
+}
+
+void render_board(board_t const *board, gate_t *gate) {
+	for (int i = 0; i < board->lines; i++) {
+		memcpy(gate->map[i], board->cells + i * board->columns,
+			board->columns);
+	}
+	for (int p = 0; p < board->num_pieces; p++) {
+		int anchor = gate->piece_y[p] * board->columns + gate->piece_x[p];
+		for (int k = 0; k < board->footprint_size[p]; k++) {
+			int cell = anchor + board->footprint[p][k];
+			char *tile = &gate->map[cell / board->columns][cell % board->columns];
+			*tile = (board->cells[cell] == 'G') ? ('H' + p) : ('0' + p);
+		}
+	}
+	gate->goals_open = count_open_goals(board, gate->piece_y[0],
+		gate->piece_x[0]);
+	gate->hash = hash_pieces(board, gate->piece_y, gate->piece_x);
+}
+
+void free_board(board_t *board) {
+	free(board);
+}
@@ -7,7 +7,6 @@
 ** Edited by Grady Fitzpatrick 2025 - adapted to Impassable Gate
 */
 
-#include <ncurses.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -19,7 +18,7 @@ gate_t find_player(gate_t gate) {
 	gate.player_y = 0;
 	for (int i = 0; i < gate.lines; i++) {
 		for (int j = 0; gate.map[i][j] != '\0'; j++) {
-			gate = check_if_player(gate, i, j);
+			check_if_player(&gate, i, j);
 		}
 	}
 	return (gate);
@@ -49,26 +48,24 @@ gate_t find_pieces(gate_t gate) {
 			}
 			// Only update if we find a piece for the first time.
 			if(gate.piece_x[pieceIndex] == -1) {
-				gate = check_if_piece(gate, i, j, piece);
+				check_if_piece(&gate, i, j, piece);
 			}
 		}
 	}
 	return (gate);
 }
 
-gate_t check_if_player(gate_t gate, int y, int x) {
-	if (gate.map[y][x] == '0' || gate.map[y][x] == 'H') {
-		gate.player_x = x;
-		gate.player_y = y;
+void check_if_player(gate_t *gate, int y, int x) {
+	if (gate->map[y][x] == '0' || gate->map[y][x] == 'H') {
+		gate->player_x = x;
+		gate->player_y = y;
 	}
-	return (gate);
 }
 
-gate_t check_if_piece(gate_t gate, int y, int x, int piece) {
-	if (gate.map[y][x] == (piece) || gate.map[y][x] == ('H' + piece - '0')) {
-		gate.piece_x[piece - '0'] = x;
-		gate.piece_y[piece - '0'] = y;
+void check_if_piece(gate_t *gate, int y, int x, int piece) {
+	if (gate->map[y][x] == (piece) || gate->map[y][x] == ('H' + piece - '0')) {
+		gate->piece_x[piece - '0'] = x;
+		gate->piece_y[piece - '0'] = y;
 	}
-	return (gate);
 }
 
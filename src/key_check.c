@@ -7,7 +7,6 @@
 ** Edited by Grady Fitzpatrick 2025 - adapted to Impassable Gate
 */
 
-#include <ncurses.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -7,7 +7,6 @@
 ** Edited by Grady Fitzpatrick 2025 - adapted to Impassable Gate
 */
 
-#include <ncurses.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
@@ -61,8 +60,6 @@ gate_t count_lines(gate_t gate) {
 	return (gate);
 }
 
-#define MAX_COLUMNS (26+2)
-#define MAX_ROWS (9+2)
 #include <assert.h>
 
 gate_t make_map(char const *path, gate_t gate) {
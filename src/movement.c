@@ -8,34 +8,29 @@
 */
 
 
-#include <ncurses.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include "../include/libmy.h"
 #include "../include/gate.h"
 
-// Tries to apply any legal action
+// Tries to apply any legal action, recording the outcome in move_status.
+// Reporting the outcome is left to the caller so the rules engine never
+// touches the terminal.
 gate_t move_location(gate_t gate, char piece, char direction){
-	//Overwrite print above...
-	mvprintw(gate.lines + 4, 0,
-		"                                                                          ");
-
 	// Valid move:
 	if(!(direction == 'u' || 
 		 direction == 'd' || 
 		 direction == 'l' || 
 		 direction == 'r')
 	  ) {
-		mvprintw(gate.lines + 4, 0, 
-			"Illegal movement direction: %c not one of {u, d, l, r}", direction);
+		gate.move_status = MOVE_ILLEGAL_DIRECTION;
 		return gate;
 	}
 
 	// Valid piece:
 	if(!(piece >= '0' || piece <= '9')) {
-		mvprintw(gate.lines + 4, 0, 
-			"Illegal piece selection: %c not one of \[0, ..., 9]", piece);
+		gate.move_status = MOVE_ILLEGAL_PIECE;
 		return gate;
 	}
 
@@ -47,7 +42,7 @@ gate_t move_location(gate_t gate, char piece, char direction){
 	gate.piece_y[piece - '0'] = -1;
 	for (int i = 0; i < gate.lines; i++) {
 		for (int j = 0; gate.map[i][j] != '\0'; j++) {
-			gate = check_if_piece(gate, i, j, piece);
+			check_if_piece(&gate, i, j, piece);
 			if (gate.piece_x[piece - '0'] != -1) {
 				break;
 			}
@@ -58,7 +53,7 @@ gate_t move_location(gate_t gate, char piece, char direction){
 	}
 	if (gate.piece_x[piece - '0'] == -1) {
 		// Didn't find piece.
-		mvprintw(gate.lines + 4, 0, "Unable to find piece on the board: %c", piece);
+		gate.move_status = MOVE_PIECE_NOT_FOUND;
 		return gate;
 	}
 
@@ -76,12 +71,12 @@ gate_t move_location(gate_t gate, char piece, char direction){
 	}
 	if (! can_move) {
 		// Didn't find piece.
-		mvprintw(gate.lines + 4, 0, "Unable to move piece %c in direction %c", piece, direction);
+		gate.move_status = MOVE_BLOCKED;
 		return gate;
 	}
 
 	// Make move:
-	mvprintw(gate.lines + 4, 0, "Making move: %c%c", piece, direction);
+	gate.move_status = MOVE_MADE;
 	// Make backup of map.
 	for (int i = 0; i < gate.lines; i++) {
 		for (int j = 0; gate.map[i][j] != '\0'; j++) {
@@ -146,7 +141,7 @@ gate_t move_location(gate_t gate, char piece, char direction){
 	gate.piece_y[piece - '0'] = -1;
 	for (int i = 0; i < gate.lines; i++) {
 		for (int j = 0; gate.map[i][j] != '\0'; j++) {
-			gate = check_if_piece(gate, i, j, piece);
+			check_if_piece(&gate, i, j, piece);
 			if (gate.piece_x[piece - '0'] != -1) {
 				break;
 			}
@@ -196,3 +191,106 @@ int part_can_move(gate_t gate, int y, int x, char direction) {
 	return can_move;
 }
 
+// Lift piece off the board at anchor (y, x), uncovering what lies beneath.
+static void lift_piece(gate_t *gate, int piece, int y, int x) {
+	board_t const *board = gate->board;
+	gate->hash ^= board->zobrist[piece][y * board->columns + x];
+	int const *fy = board->footprint_dy[piece];
+	int const *fx = board->footprint_dx[piece];
+	for (int k = 0; k < board->footprint_size[piece]; k++) {
+		int cell = (y + fy[k]) * board->columns + x + fx[k];
+		gate->map[y + fy[k]][x + fx[k]] = board->cells[cell];
+	}
+}
+
+// Put piece down with its anchor at (y, x).
+static void place_piece(gate_t *gate, int piece, int y, int x) {
+	board_t const *board = gate->board;
+	int const *fy = board->footprint_dy[piece];
+	int const *fx = board->footprint_dx[piece];
+	char digit = '0' + piece;
+	char letter = 'H' + piece;
+	gate->hash ^= board->zobrist[piece][y * board->columns + x];
+	for (int k = 0; k < board->footprint_size[piece]; k++) {
+		int cell = (y + fy[k]) * board->columns + x + fx[k];
+		gate->map[y + fy[k]][x + fx[k]] =
+			(board->cells[cell] == 'G') ? letter : digit;
+	}
+	gate->piece_y[piece] = y;
+	gate->piece_x[piece] = x;
+	if (piece == 0) {
+		gate->goals_open = count_open_goals(board, y, x);
+	}
+}
+
+// Footprint-based equivalent of move_location, applied in place. Only the
+// cells of the moving piece are read and written, using the offsets held in
+// gate->board, so the cost does not depend on the board size. The resulting
+// map, piece location and move_status match move_location; map_save is not
+// used. The returned record undoes the move through unmake_move; its piece
+// is -1 if nothing moved.
+move_undo_t make_move(gate_t *gate, int piece, char direction) {
+	board_t const *board = gate->board;
+	move_undo_t undo;
+	int dy = 0;
+	int dx = 0;
+	undo.piece = -1;
+	if (direction == 'u') {
+		dy = -1;
+	} else if (direction == 'd') {
+		dy = 1;
+	} else if (direction == 'l') {
+		dx = -1;
+	} else if (direction == 'r') {
+		dx = 1;
+	} else {
+		gate->move_status = MOVE_ILLEGAL_DIRECTION;
+		return (undo);
+	}
+	if (piece < 0 || piece >= board->num_pieces || gate->piece_x[piece] == -1) {
+		gate->move_status = MOVE_PIECE_NOT_FOUND;
+		return (undo);
+	}
+	char digit = '0' + piece;
+	char letter = 'H' + piece;
+	int size = board->footprint_size[piece];
+	int const *fy = board->footprint_dy[piece];
+	int const *fx = board->footprint_dx[piece];
+	int y = gate->piece_y[piece];
+	int x = gate->piece_x[piece];
+
+	// Dry run: every part must land on a space, a goal or the piece itself.
+	for (int k = 0; k < size; k++) {
+		char tile = gate->map[y + fy[k] + dy][x + fx[k] + dx];
+		if (tile != ' ' && tile != 'G' && tile != digit && tile != letter) {
+			gate->move_status = MOVE_BLOCKED;
+			return (undo);
+		}
+	}
+
+	// Make move: lift the piece off the board, then put it down shifted.
+	lift_piece(gate, piece, y, x);
+	place_piece(gate, piece, y + dy, x + dx);
+	gate->move_status = MOVE_MADE;
+	undo.piece = piece;
+	undo.piece_y = y;
+	undo.piece_x = x;
+	return (undo);
+}
+
+// Restores the position from before the move that returned undo. Moves
+// must be undone in reverse order.
+void unmake_move(gate_t *gate, move_undo_t const *undo) {
+	if (undo->piece == -1) {
+		return;
+	}
+	lift_piece(gate, undo->piece,
+		gate->piece_y[undo->piece], gate->piece_x[undo->piece]);
+	place_piece(gate, undo->piece, undo->piece_y, undo->piece_x);
+}
+
+// make_move for callers with no use for the undo record. Returns 1 if the
+// piece moved.
+int move_piece(gate_t *gate, int piece, char direction) {
+	return (make_move(gate, piece, direction).piece != -1);
+}
@@ -100,6 +100,36 @@ gate_t game_management(gate_t gate) {
 	mvprintw(gate.lines + 3, 0, "Direction: %c", direction);
 
 	gate = key_check(gate, piece, direction);
+	report_move(gate, piece, direction);
 	win_check(gate);
 	return (gate);
 }
+
+void report_move(gate_t gate, char piece, char direction) {
+	//Overwrite print above...
+	mvprintw(gate.lines + 4, 0,
+		"                                                                          ");
+	if (gate.move_status == MOVE_ILLEGAL_DIRECTION) {
+		mvprintw(gate.lines + 4, 0, 
+			"Illegal movement direction: %c not one of {u, d, l, r}", direction);
+	} else if (gate.move_status == MOVE_ILLEGAL_PIECE) {
+		mvprintw(gate.lines + 4, 0, 
+			"Illegal piece selection: %c not one of [0, ..., 9]", piece);
+	} else if (gate.move_status == MOVE_PIECE_NOT_FOUND) {
+		mvprintw(gate.lines + 4, 0, "Unable to find piece on the board: %c", piece);
+	} else if (gate.move_status == MOVE_BLOCKED) {
+		mvprintw(gate.lines + 4, 0, "Unable to move piece %c in direction %c", piece, direction);
+	} else {
+		mvprintw(gate.lines + 4, 0, "Making move: %c%c", piece, direction);
+	}
+}
+
+void win_check(gate_t gate) {
+	if (! is_won(gate)) {
+		return ;
+	}
+
+	endwin();
+	exit (0);
+	
+}
@@ -0,0 +1,148 @@
+/*
+** COMP20003 Assignment 3 2025
+** solver.c
+** File description:
+** Main function for the headless solver, built without ncurses
+*/
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../include/libmy.h"
+#include "../include/gate.h"
+#include "ai/ai.h"
+
+static int usage(int status) {
+	my_putstr("USAGE\n");
+	my_putstr("	./gate_solver [-a algorithm] [-e engine] [-z keys] [-d set] [-b] [-s] [-t threads]\n\t\t[-m megabytes] [-S file] [-L file] puzzle\n\n");
+	my_putstr("DESCRIPTION\n");
+	my_putstr("    -a algorithm       plain, bfs (default), iw, astar, siw,\n");
+	my_putstr("                       bfws, parallel (experimental) or portfolio\n");
+	my_putstr("    -e engine          move engine: map (default) or bitboard\n");
+	my_putstr("    -z keys            with -a bfs or portfolio, Zobrist keys for\n");
+	my_putstr("                       duplicates: off (default), verify (checked by\n");
+	my_putstr("                       the visited set) or trust\n");
+	my_putstr("    -d set             with -a bfs or portfolio, visited set: radix\n");
+	my_putstr("                       (default), hash or sharded\n");
+	my_putstr("    -b                 with -a bfs or portfolio, check each BFS layer\n");
+	my_putstr("                       in one sorted batch\n");
+	my_putstr("    -s                 with -a siw, cut revisited states out of the plan\n");
+	my_putstr("    -t threads         with -a parallel, threads to use, at most 64\n");
+	my_putstr("                       (default: one per processor)\n");
+	my_putstr("    -m megabytes       with -a portfolio, memory each search may use\n");
+	my_putstr("                       (default: no limit)\n");
+	my_putstr("    -S file            with -a bfs -d radix, save the visited set\n");
+	my_putstr("    -L file            with -a bfs -d radix, look each expanded state\n");
+	my_putstr("                       up in a visited set saved by -S\n");
+	return (status);
+}
+
+int main(int argc, char const **argv) {
+	struct solverOptions options;
+	char const *path = NULL;
+
+	defaultSolverOptions(&options);
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-h") == 0) {
+			return (usage(0));
+		} else if (strcmp(argv[i], "-a") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "plain") == 0) {
+				options.algorithm = ALGORITHM_PLAIN;
+			} else if (strcmp(argv[i], "bfs") == 0) {
+				options.algorithm = ALGORITHM_BFS;
+			} else if (strcmp(argv[i], "iw") == 0) {
+				options.algorithm = ALGORITHM_IW;
+			} else if (strcmp(argv[i], "astar") == 0) {
+				options.algorithm = ALGORITHM_ASTAR;
+			} else if (strcmp(argv[i], "siw") == 0) {
+				options.algorithm = ALGORITHM_SIW;
+			} else if (strcmp(argv[i], "bfws") == 0) {
+				options.algorithm = ALGORITHM_BFWS;
+			} else if (strcmp(argv[i], "parallel") == 0) {
+				options.algorithm = ALGORITHM_PARALLEL;
+			} else if (strcmp(argv[i], "portfolio") == 0) {
+				options.algorithm = ALGORITHM_PORTFOLIO;
+			} else {
+				return (usage(84));
+			}
+		} else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "map") == 0) {
+				options.backend = BACKEND_MAP;
+			} else if (strcmp(argv[i], "bitboard") == 0) {
+				options.backend = BACKEND_BITBOARD;
+			} else {
+				return (usage(84));
+			}
+		} else if (strcmp(argv[i], "-z") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "off") == 0) {
+				options.zobrist = ZOBRIST_OFF;
+			} else if (strcmp(argv[i], "verify") == 0) {
+				options.zobrist = ZOBRIST_VERIFY;
+			} else if (strcmp(argv[i], "trust") == 0) {
+				options.zobrist = ZOBRIST_TRUST;
+			} else {
+				return (usage(84));
+			}
+		} else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "radix") == 0) {
+				options.visited = VISITED_RADIX;
+			} else if (strcmp(argv[i], "hash") == 0) {
+				options.visited = VISITED_HASHSET;
+			} else if (strcmp(argv[i], "sharded") == 0) {
+				options.visited = VISITED_SHARDED;
+			} else {
+				return (usage(84));
+			}
+		} else if (strcmp(argv[i], "-b") == 0) {
+			options.batch = true;
+		} else if (strcmp(argv[i], "-s") == 0) {
+			options.shorten = true;
+		} else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+			options.threads = atoi(argv[++i]);
+			if (options.threads < 1) {
+				return (usage(84));
+			}
+		} else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+			long megabytes = atol(argv[++i]);
+			if (megabytes < 1) {
+				return (usage(84));
+			}
+			options.memoryBudget = megabytes * 1024 * 1024;
+		} else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+			options.saveVisited = argv[++i];
+		} else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc) {
+			options.checkVisited = argv[++i];
+		} else if (argv[i][0] != '-' && path == NULL) {
+			path = argv[i];
+		} else {
+			return (usage(84));
+		}
+	}
+	if (path == NULL || (options.batch && options.zobrist != ZOBRIST_OFF)) {
+		return (usage(84));
+	}
+	/* Options only the searches that read them accept */
+	if ((options.threads && options.algorithm != ALGORITHM_PARALLEL)
+		|| options.threads > MAXTHREADS
+		|| (options.memoryBudget && options.algorithm != ALGORITHM_PORTFOLIO)
+		|| (options.shorten && options.algorithm != ALGORITHM_SIW)) {
+		return (usage(84));
+	}
+	/* Visited set choices of algorithm 2, run alone or in the portfolio */
+	if ((options.batch || options.zobrist != ZOBRIST_OFF || options.visited != VISITED_RADIX)
+		&& options.algorithm != ALGORITHM_BFS && options.algorithm != ALGORITHM_PORTFOLIO) {
+		return (usage(84));
+	}
+	/* Snapshots hold the radix tree visited set of algorithm 2 only */
+	if ((options.saveVisited || options.checkVisited)
+		&& (options.algorithm != ALGORITHM_BFS || options.visited != VISITED_RADIX
+		|| options.zobrist == ZOBRIST_TRUST)) {
+		return (usage(84));
+	}
+	solveWithOptions(path, &options);
+	return (0);
+}
@@ -7,23 +7,19 @@
 ** Edited by Grady Fitzpatrick 2025 - adapted to Impassable Gate
 */
 
-#include <ncurses.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <fcntl.h>
 #include "../include/libmy.h"
 #include "../include/gate.h"
 
-void win_check(gate_t gate) {
+int is_won(gate_t gate) {
 	for (int i = 0; i < gate.lines; i++) {
 		for (int j = 0; gate.map_save[i][j] != '\0'; j++) {
 			if (gate.map[i][j] == 'G' || (gate.map[i][j] >= 'I' && gate.map[i][j] <= 'Q')) {
-				return ;
+				return (0);
 			}
 		}
 	}
-
-	endwin();
-	exit (0);
-	
+	return (1);
 }